@@ -7,6 +7,7 @@
 
 #include "p1_process.h"
 #include "p1_threads.h"
+#include "p1_io.h"
 
 using namespace std;
 
@@ -22,19 +23,40 @@ int main(int argc, char** argv) {
   class_name.push_back("algorithm");
   class_name.push_back("digital-design");
 
+  // Optional arguments after the two counts
+  p1_options options;
+  bool options_valid = true;
+  for (int i = 3; i < argc; ++i) {
+      if (strncmp(argv[i], "--numa=", 7) == 0 && atoi(argv[i] + 7) > 0) {
+          options.numa_nodes = atoi(argv[i] + 7);
+      } else if (strcmp(argv[i], "--io=stdio") == 0) {
+          options.io_backend = IO_STDIO;
+      } else if (strcmp(argv[i], "--io=thread") == 0) {
+          options.io_backend = IO_THREAD;
+      } else if (strcmp(argv[i], "--io=uring") == 0) {
+          options.io_backend = IO_URING;
+      } else {
+          options_valid = false;
+      }
+  }
+
   // Check the argument and print error message if the argument is wrong
-  if(argc == 3 && (atoi(argv[1]) > 0 && atoi(argv[2]) > 0))
+  if(argc >= 3 && options_valid && (atoi(argv[1]) > 0 && atoi(argv[2]) > 0))
   {
       num_processes = atoi(argv[1]);
       num_threads = atoi(argv[2]);
       
       // Create the child processes and sort
-      create_processes_and_sort(class_name, num_processes, num_threads);
+      create_processes_and_sort(class_name, num_processes, num_threads, options);
   }
   else
   {
       printf("[ERROR] Expecting 2 arguments with integral value greater than zero.\n");
-      printf("[USAGE] %s <number of processes> <number of threads>\n", argv[0]);
+      printf("[USAGE] %s <number of processes> <number of threads> [--numa=<nodes>] [--io=stdio|thread|uring]\n", argv[0]);
+      printf("        --numa=<nodes>  pin sort threads and place their data on <nodes> NUMA nodes\n");
+      printf("                        (more nodes than the machine has are simulated)\n");
+      printf("        --io=<backend>  class file I/O: blocking stdio (default), read-ahead and\n");
+      printf("                        write-behind on a helper thread, or io_uring\n");
   }
   printf("Main process is terminated. (pid: %d)\n", getpid());
   return 0;
@@ -0,0 +1,683 @@
+#include <algorithm>
+#include <vector>
+#include <deque>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdarg>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+
+#include "p1_io.h"
+
+using namespace std;
+
+// This file implements the class file I/O backends
+//
+// The asynchronous backends keep IO_DEPTH buffers of IO_CHUNK bytes. The reader
+// keeps all of them in flight ahead of the parser and the writer formats into
+// one while the previous ones are being written. A thread opens its files one
+// after another, so it keeps one engine per backend and lends it to each
+// reader or writer in turn instead of setting up a ring (or helper thread) and
+// the buffers for every file.
+
+#define IO_DEPTH 4
+#define IO_CHUNK (1 << 20)
+
+
+const char *io_backend_name(int backend) {
+  switch (backend) {
+    case IO_THREAD: return "thread";
+    case IO_URING:  return "io_uring";
+    default:        return "stdio";
+  }
+}
+
+// Finish a transfer the kernel only did part of, synchronously
+static long transfer_rest(bool write, int fd, char *buffer, off_t offset, size_t length, long done) {
+  while (done >= 0 && (size_t)done < length) {
+    ssize_t n = write ? pwrite(fd, buffer + done, length - done, offset + done)
+                      : pread(fd, buffer + done, length - done, offset + done);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0) {
+      return -errno;
+    }
+    if (n == 0) {
+      break;
+    }
+    done += n;
+  }
+  return done;
+}
+
+
+// Base class of the asynchronous backends: owns the page-aligned buffers, one per slot.
+// Each slot has at most one request in flight.
+class IoEngine {
+  protected:
+    vector<char *> buffers;
+    size_t buffer_size;
+
+  public:
+    IoEngine(int slots, size_t size) {
+      buffer_size = size;
+      for (int i = 0; i < slots; ++i) {
+        void *buffer = NULL;
+        if (posix_memalign(&buffer, 4096, size) != 0) {
+          perror("posix_memalign");
+          exit(1);
+        }
+        buffers.push_back((char *) buffer);
+      }
+    }
+
+    virtual ~IoEngine() {
+      for (size_t i = 0; i < buffers.size(); ++i) {
+        free(buffers[i]);
+      }
+    }
+
+    char *buffer(int slot) {
+      return buffers[slot];
+    }
+
+    // Start reading / writing length bytes of the slot's buffer at offset
+    virtual void submit(int slot, bool write, int fd, off_t offset, size_t length) = 0;
+
+    // Wait for the slot's request, returns the bytes transferred or -errno
+    virtual long wait(int slot) = 0;
+};
+
+
+// Requests are served in order by one helper thread with pread / pwrite
+class ThreadEngine : public IoEngine {
+  private:
+    struct request {
+      int slot;
+      bool write;
+      int fd;
+      off_t offset;
+      size_t length;
+    };
+
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t requested;
+    pthread_cond_t completed;
+    deque<request> requests;
+    vector<long> results;
+    vector<bool> done;
+    bool stopping;
+
+    static void *run(void *args) {
+      ThreadEngine *engine = (ThreadEngine *) args;
+      pthread_mutex_lock(&engine->mutex);
+      while (true) {
+        while (engine->requests.empty() && !engine->stopping) {
+          pthread_cond_wait(&engine->requested, &engine->mutex);
+        }
+        if (engine->requests.empty()) {
+          break;
+        }
+        request r = engine->requests.front();
+        engine->requests.pop_front();
+        pthread_mutex_unlock(&engine->mutex);
+
+        long n = transfer_rest(r.write, r.fd, engine->buffers[r.slot], r.offset, r.length, 0);
+
+        pthread_mutex_lock(&engine->mutex);
+        engine->results[r.slot] = n;
+        engine->done[r.slot] = true;
+        pthread_cond_broadcast(&engine->completed);
+      }
+      pthread_mutex_unlock(&engine->mutex);
+      return NULL;
+    }
+
+  public:
+    ThreadEngine(int slots, size_t size) : IoEngine(slots, size), results(slots, 0), done(slots, false) {
+      stopping = false;
+      pthread_mutex_init(&mutex, NULL);
+      pthread_cond_init(&requested, NULL);
+      pthread_cond_init(&completed, NULL);
+      if (pthread_create(&thread, NULL, run, this) != 0) {
+        printf("thread_create \n");
+        exit(1);
+      }
+    }
+
+    ~ThreadEngine() {
+      pthread_mutex_lock(&mutex);
+      stopping = true;
+      pthread_cond_signal(&requested);
+      pthread_mutex_unlock(&mutex);
+      pthread_join(thread, NULL);
+      pthread_cond_destroy(&completed);
+      pthread_cond_destroy(&requested);
+      pthread_mutex_destroy(&mutex);
+    }
+
+    void submit(int slot, bool write, int fd, off_t offset, size_t length) {
+      request r;
+      r.slot = slot;
+      r.write = write;
+      r.fd = fd;
+      r.offset = offset;
+      r.length = length;
+      pthread_mutex_lock(&mutex);
+      done[slot] = false;
+      requests.push_back(r);
+      pthread_cond_signal(&requested);
+      pthread_mutex_unlock(&mutex);
+    }
+
+    long wait(int slot) {
+      pthread_mutex_lock(&mutex);
+      while (!done[slot]) {
+        pthread_cond_wait(&completed, &mutex);
+      }
+      done[slot] = false;
+      long n = results[slot];
+      pthread_mutex_unlock(&mutex);
+      return n;
+    }
+};
+
+
+// io_uring through the raw system calls (no liburing). The slot buffers are
+// registered with the ring so reads and writes use the _FIXED opcodes; if the
+// registration is refused (e.g. RLIMIT_MEMLOCK) the plain opcodes are used.
+class UringEngine : public IoEngine {
+  private:
+    int ring_fd;
+    bool fixed_buffers;
+
+    void *sq_ring;
+    size_t sq_ring_size;
+    void *cq_ring;
+    size_t cq_ring_size;
+    struct io_uring_sqe *sqes;
+    size_t sqes_size;
+
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_cqe *cqes;
+
+    vector<long> results;
+    vector<bool> done;
+
+    int enter(unsigned to_submit, unsigned min_complete, unsigned flags) {
+      return syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, NULL, 0);
+    }
+
+    void reap() {
+      unsigned head = *cq_head;
+      unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+      while (head != tail) {
+        const struct io_uring_cqe &cqe = cqes[head & *cq_mask];
+        results[cqe.user_data] = cqe.res;
+        done[cqe.user_data] = true;
+        ++head;
+      }
+      __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+    }
+
+  public:
+    UringEngine(int slots, size_t size) : IoEngine(slots, size), results(slots, 0), done(slots, false) {
+      sq_ring = cq_ring = MAP_FAILED;
+      sqes = (struct io_uring_sqe *) MAP_FAILED;
+      fixed_buffers = false;
+
+      struct io_uring_params params;
+      memset(&params, 0, sizeof(params));
+      ring_fd = syscall(__NR_io_uring_setup, 2 * slots, &params);
+      if (ring_fd < 0) {
+        return;
+      }
+
+      sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+      cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+      bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+      if (single_mmap) {
+        sq_ring_size = cq_ring_size = max(sq_ring_size, cq_ring_size);
+      }
+
+      sq_ring = mmap(NULL, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     ring_fd, IORING_OFF_SQ_RING);
+      cq_ring = single_mmap ? sq_ring
+                            : mmap(NULL, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                   ring_fd, IORING_OFF_CQ_RING);
+      sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+      sqes = (struct io_uring_sqe *) mmap(NULL, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                          ring_fd, IORING_OFF_SQES);
+      if (sq_ring == MAP_FAILED || cq_ring == MAP_FAILED || sqes == MAP_FAILED) {
+        ::close(ring_fd);
+        ring_fd = -1;
+        return;
+      }
+
+      char *sq = (char *) sq_ring;
+      char *cq = (char *) cq_ring;
+      sq_tail = (unsigned *) (sq + params.sq_off.tail);
+      sq_mask = (unsigned *) (sq + params.sq_off.ring_mask);
+      sq_array = (unsigned *) (sq + params.sq_off.array);
+      cq_head = (unsigned *) (cq + params.cq_off.head);
+      cq_tail = (unsigned *) (cq + params.cq_off.tail);
+      cq_mask = (unsigned *) (cq + params.cq_off.ring_mask);
+      cqes = (struct io_uring_cqe *) (cq + params.cq_off.cqes);
+
+      vector<struct iovec> iovecs(slots);
+      for (int i = 0; i < slots; ++i) {
+        iovecs[i].iov_base = buffers[i];
+        iovecs[i].iov_len = size;
+      }
+      fixed_buffers = syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_BUFFERS,
+                              &iovecs[0], slots) == 0;
+    }
+
+    ~UringEngine() {
+      if (sqes != MAP_FAILED) {
+        munmap(sqes, sqes_size);
+      }
+      if (cq_ring != MAP_FAILED && cq_ring != sq_ring) {
+        munmap(cq_ring, cq_ring_size);
+      }
+      if (sq_ring != MAP_FAILED) {
+        munmap(sq_ring, sq_ring_size);
+      }
+      if (ring_fd >= 0) {
+        ::close(ring_fd);
+      }
+    }
+
+    bool ok() const {
+      return ring_fd >= 0;
+    }
+
+    void submit(int slot, bool write, int fd, off_t offset, size_t length) {
+      unsigned tail = *sq_tail;
+      unsigned index = tail & *sq_mask;
+      struct io_uring_sqe *sqe = &sqes[index];
+      memset(sqe, 0, sizeof(*sqe));
+      if (fixed_buffers) {
+        sqe->opcode = write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+        sqe->buf_index = slot;
+      } else {
+        sqe->opcode = write ? IORING_OP_WRITE : IORING_OP_READ;
+      }
+      sqe->fd = fd;
+      sqe->off = offset;
+      sqe->addr = (unsigned long) buffers[slot];
+      sqe->len = length;
+      sqe->user_data = slot;
+      sq_array[index] = index;
+
+      done[slot] = false;
+      __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+      int submitted;
+      while ((submitted = enter(1, 0, 0)) < 0 && errno == EINTR) {
+      }
+      if (submitted != 1) {
+        // The kernel did not take the entry: take it back and let wait() report why
+        __atomic_store_n(sq_tail, tail, __ATOMIC_RELEASE);
+        results[slot] = submitted < 0 ? -errno : -EAGAIN;
+        done[slot] = true;
+      }
+    }
+
+    long wait(int slot) {
+      reap();
+      while (!done[slot]) {
+        if (enter(0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+          return -errno;
+        }
+        reap();
+      }
+      done[slot] = false;
+      return results[slot];
+    }
+};
+
+
+// NULL for IO_STDIO. io_uring falls back to the thread backend when the kernel
+// (or a seccomp policy) refuses to set up a ring.
+static IoEngine *create_io_engine(int backend) {
+  if (backend == IO_URING) {
+    UringEngine *engine = new UringEngine(IO_DEPTH, IO_CHUNK);
+    if (engine->ok()) {
+      return engine;
+    }
+    delete engine;
+
+    static bool warned = false;
+    if (!__sync_lock_test_and_set(&warned, true)) {
+      printf("io_uring is not available, using the thread backend. (pid: %d)\n", getpid());
+    }
+    backend = IO_THREAD;
+  }
+  if (backend == IO_THREAD) {
+    return new ThreadEngine(IO_DEPTH, IO_CHUNK);
+  }
+  return NULL;
+}
+
+// The engines of a thread, by backend
+struct thread_engines {
+  IoEngine *engine[IO_URING + 1];
+  bool lent[IO_URING + 1];
+};
+
+static pthread_key_t engines_key;
+static pthread_once_t engines_once = PTHREAD_ONCE_INIT;
+
+static void free_thread_engines(void *args) {
+  thread_engines *engines = (thread_engines *) args;
+  for (int b = 0; b <= IO_URING; ++b) {
+    delete engines->engine[b];
+  }
+  delete engines;
+}
+
+static void create_engines_key() {
+  pthread_key_create(&engines_key, free_thread_engines);
+}
+
+// The calling thread's engine for the backend, created on first use. NULL for
+// IO_STDIO. A thread with two files open at once gets a private engine for the
+// second one.
+static IoEngine *acquire_io_engine(int backend) {
+  if (backend != IO_THREAD && backend != IO_URING) {
+    return NULL;
+  }
+  pthread_once(&engines_once, create_engines_key);
+  thread_engines *engines = (thread_engines *) pthread_getspecific(engines_key);
+  if (engines == NULL) {
+    engines = new thread_engines();
+    pthread_setspecific(engines_key, engines);
+  }
+  if (engines->lent[backend]) {
+    return create_io_engine(backend);
+  }
+  if (engines->engine[backend] == NULL) {
+    engines->engine[backend] = create_io_engine(backend);
+  }
+  engines->lent[backend] = true;
+  return engines->engine[backend];
+}
+
+// Give the engine back once nothing is in flight on it
+static void release_io_engine(IoEngine *engine) {
+  if (engine == NULL) {
+    return;
+  }
+  thread_engines *engines = (thread_engines *) pthread_getspecific(engines_key);
+  for (int b = 0; engines != NULL && b <= IO_URING; ++b) {
+    if (engines->engine[b] == engine) {
+      engines->lent[b] = false;
+      return;
+    }
+  }
+  delete engine;
+}
+
+
+// ---- ClassReader ----
+
+ClassReader::ClassReader(const char *path, int backend)
+  : slot_offset(IO_DEPTH, 0), slot_length(IO_DEPTH, 0), slot_pending(IO_DEPTH, false) {
+  file = NULL;
+  fd = -1;
+  engine = NULL;
+  file_size = 0;
+  next_offset = 0;
+  current = -1;
+  data = NULL;
+  pos = 0;
+  length = 0;
+
+  if (backend == IO_STDIO) {
+    file = fopen(path, "r");
+    return;
+  }
+
+  fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return;
+  }
+  struct stat st;
+  if (fstat(fd, &st) == 0) {
+    file_size = st.st_size;
+  }
+  engine = acquire_io_engine(backend);
+  for (int slot = 0; slot < IO_DEPTH; ++slot) {
+    issue(slot);
+  }
+}
+
+ClassReader::~ClassReader() {
+  // Drain reads still in flight before the buffers go away
+  for (int slot = 0; slot < IO_DEPTH; ++slot) {
+    if (slot_pending[slot]) {
+      engine->wait(slot);
+    }
+  }
+  release_io_engine(engine);
+  if (fd >= 0) {
+    ::close(fd);
+  }
+  if (file) {
+    fclose(file);
+  }
+}
+
+bool ClassReader::is_open() const {
+  return file != NULL || fd >= 0;
+}
+
+// Start reading the next chunk of the file into the slot, if any is left
+void ClassReader::issue(int slot) {
+  slot_pending[slot] = next_offset < file_size;
+  if (!slot_pending[slot]) {
+    return;
+  }
+  size_t chunk = file_size - next_offset < IO_CHUNK ? file_size - next_offset : IO_CHUNK;
+  slot_offset[slot] = next_offset;
+  slot_length[slot] = chunk;
+  engine->submit(slot, false, fd, next_offset, chunk);
+  next_offset += chunk;
+}
+
+// Recycle the consumed slot for read-ahead and move on to the next chunk
+bool ClassReader::advance() {
+  if (current >= 0) {
+    issue(current);
+  }
+  current = (current + 1) % IO_DEPTH;
+  if (!slot_pending[current]) {
+    return false;
+  }
+
+  long n = engine->wait(current);
+  slot_pending[current] = false;
+  n = transfer_rest(false, fd, engine->buffer(current), slot_offset[current], slot_length[current], n);
+  if (n < 0) {
+    errno = -n;
+    perror("read");
+    exit(1);
+  }
+  data = engine->buffer(current);
+  pos = 0;
+  length = n;
+  return length > 0;
+}
+
+char *ClassReader::gets(char *line, int size) {
+  if (file) {
+    return fgets(line, size, file);
+  }
+
+  size_t n = 0;
+  while (n + 1 < (size_t)size) {
+    if (pos == length && !advance()) {
+      break;
+    }
+    size_t take = length - pos;
+    if (take > size - 1 - n) {
+      take = size - 1 - n;
+    }
+    const char *newline = (const char *) memchr(data + pos, '\n', take);
+    if (newline) {
+      take = newline - (data + pos) + 1;
+    }
+    memcpy(line + n, data + pos, take);
+    n += take;
+    pos += take;
+    if (newline) {
+      break;
+    }
+  }
+  if (n == 0) {
+    return NULL;
+  }
+  line[n] = '\0';
+  return line;
+}
+
+
+// ---- ClassWriter ----
+
+ClassWriter::ClassWriter(const char *path, int backend)
+  : slot_offset(IO_DEPTH, 0), slot_length(IO_DEPTH, 0), slot_pending(IO_DEPTH, false) {
+  file = NULL;
+  fd = -1;
+  engine = NULL;
+  offset = 0;
+  current = 0;
+  fill = 0;
+
+  if (backend == IO_STDIO) {
+    file = fopen(path, "w");
+    return;
+  }
+
+  fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return;
+  }
+  engine = acquire_io_engine(backend);
+}
+
+ClassWriter::~ClassWriter() {
+  close();
+}
+
+bool ClassWriter::is_open() const {
+  return file != NULL || fd >= 0;
+}
+
+// Wait for the slot's write and finish it if it came back short
+void ClassWriter::complete(int slot) {
+  long n = engine->wait(slot);
+  slot_pending[slot] = false;
+  n = transfer_rest(true, fd, engine->buffer(slot), slot_offset[slot], slot_length[slot], n);
+  if (n < 0 || (size_t)n != slot_length[slot]) {
+    errno = n < 0 ? -n : EIO;
+    perror("write");
+    exit(1);
+  }
+}
+
+// Hand the filled buffer to the backend and continue in the next slot
+void ClassWriter::flush_current() {
+  if (fill == 0) {
+    return;
+  }
+  slot_offset[current] = offset;
+  slot_length[current] = fill;
+  slot_pending[current] = true;
+  engine->submit(current, true, fd, offset, fill);
+  offset += fill;
+  fill = 0;
+
+  current = (current + 1) % IO_DEPTH;
+  if (slot_pending[current]) {
+    complete(current);
+  }
+}
+
+void ClassWriter::write(const char *data, size_t size) {
+  while (size > 0) {
+    size_t take = IO_CHUNK - fill;
+    if (take > size) {
+      take = size;
+    }
+    memcpy(engine->buffer(current) + fill, data, take);
+    fill += take;
+    data += take;
+    size -= take;
+    if (fill == IO_CHUNK) {
+      flush_current();
+    }
+  }
+}
+
+int ClassWriter::printf(const char *format, ...) {
+  va_list args;
+  va_start(args, format);
+  if (file) {
+    int n = vfprintf(file, format, args);
+    va_end(args);
+    return n;
+  }
+
+  char text[512];
+  int n = vsnprintf(text, sizeof(text), format, args);
+  va_end(args);
+  if (n < 0) {
+    return n;
+  }
+  if ((size_t)n < sizeof(text)) {
+    write(text, n);
+    return n;
+  }
+
+  vector<char> long_text(n + 1);
+  va_start(args, format);
+  vsnprintf(&long_text[0], long_text.size(), format, args);
+  va_end(args);
+  write(&long_text[0], n);
+  return n;
+}
+
+void ClassWriter::close() {
+  if (file) {
+    fclose(file);
+    file = NULL;
+  }
+  if (fd < 0) {
+    return;
+  }
+  flush_current();
+  for (int slot = 0; slot < IO_DEPTH; ++slot) {
+    if (slot_pending[slot]) {
+      complete(slot);
+    }
+  }
+  release_io_engine(engine);
+  engine = NULL;
+  ::close(fd);
+  fd = -1;
+}
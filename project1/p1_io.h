@@ -0,0 +1,83 @@
+#ifndef __P1_IO
+#define __P1_IO
+
+#include <cstdio>
+#include <vector>
+#include <sys/types.h>
+
+// Backends for reading the class files and writing the output files
+enum io_backend {
+  IO_STDIO = 0,   // blocking fopen / fgets / fprintf
+  IO_THREAD,      // read-ahead and write-behind on a helper thread (pread / pwrite)
+  IO_URING        // read-ahead and write-behind through io_uring with registered buffers
+};
+
+const char *io_backend_name(int backend);
+
+// Issues reads and writes of fixed-size buffers and waits for them, see p1_io.cpp
+class IoEngine;
+
+// Sequential line reader. With an asynchronous backend, several large chunks
+// of the file are in flight ahead of the parser at any time.
+class ClassReader {
+  private:
+    FILE *file;
+    int fd;
+    IoEngine *engine;
+    off_t file_size;
+    off_t next_offset;
+    std::vector<off_t> slot_offset;
+    std::vector<size_t> slot_length;
+    std::vector<bool> slot_pending;
+    int current;
+    const char *data;
+    size_t pos;
+    size_t length;
+
+    ClassReader(const ClassReader &);
+    ClassReader &operator=(const ClassReader &);
+
+    void issue(int slot);
+    bool advance();
+
+  public:
+    ClassReader(const char *path, int backend);
+    ~ClassReader();
+
+    bool is_open() const;
+
+    // Same contract as fgets: copies the next line, at most size - 1 bytes of it
+    char *gets(char *line, int size);
+};
+
+// Sequential formatted writer. With an asynchronous backend, output is
+// formatted into large buffers that are written behind the formatter.
+class ClassWriter {
+  private:
+    FILE *file;
+    int fd;
+    IoEngine *engine;
+    off_t offset;
+    std::vector<off_t> slot_offset;
+    std::vector<size_t> slot_length;
+    std::vector<bool> slot_pending;
+    int current;
+    size_t fill;
+
+    ClassWriter(const ClassWriter &);
+    ClassWriter &operator=(const ClassWriter &);
+
+    void complete(int slot);
+    void flush_current();
+    void write(const char *data, size_t size);
+
+  public:
+    ClassWriter(const char *path, int backend);
+    ~ClassWriter();
+
+    bool is_open() const;
+    int printf(const char *format, ...);
+    void close();
+};
+
+#endif
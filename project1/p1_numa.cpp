@@ -0,0 +1,164 @@
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+
+#include "p1_numa.h"
+
+using namespace std;
+
+// This file implements the NUMA placement helpers used by ParallelMergeSorter
+
+
+// Parse a sysfs list such as "0-3,8-11" into its members
+static vector<int> parse_cpu_list(const char *text) {
+  vector<int> result;
+  const char *p = text;
+  while (*p != '\0' && *p != '\n') {
+    char *end;
+    long first = strtol(p, &end, 10);
+    if (end == p) {
+      break;
+    }
+    long last = first;
+    p = end;
+    if (*p == '-') {
+      last = strtol(p + 1, &end, 10);
+      p = end;
+    }
+    for (long i = first; i <= last; ++i) {
+      result.push_back((int)i);
+    }
+    if (*p == ',') {
+      ++p;
+    }
+  }
+  return result;
+}
+
+// Read the first line of a sysfs file and parse it as a list, empty on failure
+static vector<int> read_sysfs_list(const char *path) {
+  char line[1024];
+  vector<int> result;
+  FILE *file = fopen(path, "r");
+  if (!file) {
+    return result;
+  }
+  if (fgets(line, sizeof(line), file)) {
+    result = parse_cpu_list(line);
+  }
+  fclose(file);
+  return result;
+}
+
+NumaTopology::NumaTopology(int requested_nodes) {
+  vector<int> real_nodes = read_sysfs_list("/sys/devices/system/node/online");
+  vector<vector<int> > real_cpus;
+  vector<int> all_cpus;
+
+  for (size_t i = 0; i < real_nodes.size(); ++i) {
+    char path[128];
+    sprintf(path, "/sys/devices/system/node/node%d/cpulist", real_nodes[i]);
+    vector<int> cpus = read_sysfs_list(path);
+    real_cpus.push_back(cpus);
+    all_cpus.insert(all_cpus.end(), cpus.begin(), cpus.end());
+  }
+
+  // No sysfs (or no CPUs reported): treat the machine as a single node
+  if (all_cpus.empty()) {
+    real_nodes.clear();
+    real_nodes.push_back(0);
+    real_cpus.clear();
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    for (long i = 0; i < (online > 0 ? online : 1); ++i) {
+      all_cpus.push_back((int)i);
+    }
+    real_cpus.push_back(all_cpus);
+  }
+
+  if (requested_nodes < 1) {
+    requested_nodes = 1;
+  }
+
+  if (requested_nodes <= (int)real_nodes.size()) {
+    // Use the first requested_nodes real nodes as they are
+    for (int i = 0; i < requested_nodes; ++i) {
+      node_cpus.push_back(real_cpus[i]);
+      memory_node.push_back(real_nodes[i]);
+    }
+  } else {
+    // Simulate: split the online CPUs into requested_nodes contiguous groups
+    int cpu_count = all_cpus.size();
+    for (int i = 0; i < requested_nodes; ++i) {
+      vector<int> cpus;
+      int first = (long)i * cpu_count / requested_nodes;
+      int last = (long)(i + 1) * cpu_count / requested_nodes;
+      for (int k = first; k < last; ++k) {
+        cpus.push_back(all_cpus[k]);
+      }
+      // More nodes than CPUs, nodes share CPUs round-robin
+      if (cpus.empty()) {
+        cpus.push_back(all_cpus[i % cpu_count]);
+      }
+      node_cpus.push_back(cpus);
+      memory_node.push_back(real_nodes[i % real_nodes.size()]);
+    }
+  }
+}
+
+int NumaTopology::num_nodes() const {
+  return node_cpus.size();
+}
+
+// Threads are assigned to nodes in contiguous blocks, so neighbouring slices
+// of the list (which are merged first) live on the same node
+int NumaTopology::node_of_thread(int thread_index, int num_threads) const {
+  return (long)thread_index * num_nodes() / num_threads;
+}
+
+int NumaTopology::cpu_of_thread(int thread_index, int num_threads) const {
+  int node = node_of_thread(thread_index, num_threads);
+
+  // Rank of this thread among the threads of its node
+  int first_thread = thread_index;
+  while (first_thread > 0 && node_of_thread(first_thread - 1, num_threads) == node) {
+    --first_thread;
+  }
+  const vector<int> &cpus = node_cpus[node];
+  return cpus[(thread_index - first_thread) % cpus.size()];
+}
+
+int NumaTopology::first_cpu_of_node(int node) const {
+  return node_cpus[node][0];
+}
+
+bool NumaTopology::pin_current_thread(int cpu) const {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+// Prefer the given node for the pages of [addr, addr + length). Only whole
+// pages are bound; the partial pages at the edges are left to first touch.
+bool NumaTopology::bind_memory(void *addr, size_t length, int node) const {
+  unsigned long page = sysconf(_SC_PAGESIZE);
+  unsigned long begin = ((unsigned long)addr + page - 1) & ~(page - 1);
+  unsigned long end = ((unsigned long)addr + length) & ~(page - 1);
+  if (end <= begin) {
+    return true;
+  }
+
+  int real_node = memory_node[node];
+  unsigned long mask[16];
+  memset(mask, 0, sizeof(mask));
+  mask[real_node / (8 * sizeof(unsigned long))] |= 1UL << (real_node % (8 * sizeof(unsigned long)));
+
+  long ret = syscall(SYS_mbind, begin, end - begin, MPOL_PREFERRED, mask,
+                     8 * sizeof(mask), 0);
+  return ret == 0;
+}
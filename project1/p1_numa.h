@@ -0,0 +1,30 @@
+#ifndef __P1_NUMA
+#define __P1_NUMA
+
+#include <vector>
+#include <cstddef>
+
+// NUMA topology used to place the sort workers and their slices of the list.
+//
+// Nodes are read from /sys/devices/system/node. When more nodes are requested
+// than the machine has, the online CPUs are split evenly between the simulated
+// nodes and each simulated node is backed by a real node round-robin, so the
+// placement logic can be exercised on a single-node box.
+class NumaTopology {
+  private:
+    std::vector<std::vector<int> > node_cpus;
+    std::vector<int> memory_node;
+
+  public:
+    NumaTopology(int requested_nodes);
+
+    int num_nodes() const;
+    int node_of_thread(int thread_index, int num_threads) const;
+    int cpu_of_thread(int thread_index, int num_threads) const;
+    int first_cpu_of_node(int node) const;
+
+    bool pin_current_thread(int cpu) const;
+    bool bind_memory(void *addr, size_t length, int node) const;
+};
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef __P1_PIPELINE
+#define __P1_PIPELINE
+
+#include <deque>
+#include <pthread.h>
+
+// Fixed-capacity blocking queue used to hand work between pipeline stages.
+// push() waits while the queue is full and pop() waits while it is empty, so a
+// fast stage can run at most `capacity` items ahead of the stage after it.
+template <typename T>
+class BoundedQueue {
+  private:
+    std::deque<T> items;
+    size_t capacity;
+    pthread_mutex_t mutex;
+    pthread_cond_t not_full;
+    pthread_cond_t not_empty;
+
+    BoundedQueue(const BoundedQueue &);
+    BoundedQueue &operator=(const BoundedQueue &);
+
+  public:
+    BoundedQueue(size_t capacity) {
+      this->capacity = capacity > 0 ? capacity : 1;
+      pthread_mutex_init(&mutex, NULL);
+      pthread_cond_init(&not_full, NULL);
+      pthread_cond_init(&not_empty, NULL);
+    }
+
+    ~BoundedQueue() {
+      pthread_cond_destroy(&not_empty);
+      pthread_cond_destroy(&not_full);
+      pthread_mutex_destroy(&mutex);
+    }
+
+    void push(const T &item) {
+      pthread_mutex_lock(&mutex);
+      while (items.size() >= capacity) {
+        pthread_cond_wait(&not_full, &mutex);
+      }
+      items.push_back(item);
+      pthread_cond_signal(&not_empty);
+      pthread_mutex_unlock(&mutex);
+    }
+
+    T pop() {
+      pthread_mutex_lock(&mutex);
+      while (items.empty()) {
+        pthread_cond_wait(&not_empty, &mutex);
+      }
+      T item = items.front();
+      items.pop_front();
+      pthread_cond_signal(&not_full);
+      pthread_mutex_unlock(&mutex);
+      return item;
+    }
+};
+
+#endif
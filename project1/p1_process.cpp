@@ -7,18 +7,158 @@
 #include <cmath>
 #include <unistd.h>
 #include <sys/wait.h>
+#include <pthread.h>
 
 #include "p1_process.h"
 #include "p1_threads.h"
+#include "p1_pipeline.h"
+#include "p1_io.h"
 
 using namespace std;
 
 // This file implements the multi-processing logic for the project
 
 
+// One class travelling through the read -> sort -> write pipeline
+struct class_job {
+  string class_name;
+  vector<student> students;
+
+  class_job(const string &class_name) {
+    this->class_name = class_name;
+  }
+};
+
+// Arguments of the reader and writer stage threads
+struct stage_args {
+  vector<string> classes;
+  int io_backend;
+  BoundedQueue<class_job *> *queue;
+};
+
+
+// Stage 1: parse input/<class>.csv into a list of students
+void read_class(class_job *job, int io_backend) {
+  char buffer[40];
+  sprintf(buffer, "input/%s.csv", job->class_name.c_str());
+  string input_file_name(buffer);
+
+  // Your implementation goes here, you will need to implement:
+  // File I/O
+  //  - This means reading the input file, and creating a list of students,
+  //  see p1_process.h for the definition of the student struct
+  //
+  ClassReader input_file(input_file_name.c_str(), io_backend);
+  if (!input_file.is_open()) {
+    perror(("Failed to open " + input_file_name).c_str());
+    exit(1);
+  }
+  // Read Header
+  char header[128];
+  input_file.gets(header, sizeof(header));
+
+  // Read Each line data
+  char line[128];
+  while (input_file.gets(line, sizeof(line))) {
+      unsigned long id;
+      double score;
+
+      if (sscanf(line, "%lu,%lf", &id, &score) == 2) {
+          student s(id,score);
+          job->students.push_back(s);
+      }
+  }
+  printf("%s, student amount: %ld \n",job->class_name.c_str(), job->students.size());
+}
+
+// Stage 3: write output/<class>_sorted.csv and output/<class>_stats.csv
+void write_class(const class_job *job, int io_backend) {
+  char buffer[40];
+  sprintf(buffer, "output/%s_sorted.csv", job->class_name.c_str());
+  string output_sorted_file_name(buffer);
+
+  sprintf(buffer, "output/%s_stats.csv", job->class_name.c_str());
+  string output_stats_file_name(buffer);
+
+  const vector<student> &sorted = job->students;
+
+  double Average = 0.0;
+  double Median = 0.0;
+  double Std_Dev = 0.0;
+
+  ClassWriter output_sorted_file(output_sorted_file_name.c_str(), io_backend);
+  if (!output_sorted_file.is_open()) {
+    perror(("Failed to open " + output_sorted_file_name).c_str());
+    exit(1);
+  }
+
+  output_sorted_file.printf("Rank,Student ID,Grade\n");
+  int students_size = sorted.size();
+
+  int n = 0;
+  double M2 = 0.0;
+
+  for (int i = 0; i< students_size;i++){
+    const student &s = sorted[i];
+    output_sorted_file.printf("%d,%lu,%lf \n", (i+1), s.id, s.grade);
+    
+    n++;
+
+    double delta = s.grade - Average;
+    Average += delta / n;
+    M2 += delta * (s.grade - Average);  // Welford's update
+  }
+
+
+  if (students_size % 2 == 0) {
+    Median = (sorted[students_size / 2 - 1].grade + sorted[students_size / 2].grade) / 2.0;
+  } else {
+    Median = sorted[students_size / 2].grade;
+  }
+  Std_Dev = sqrt(M2 / students_size); 
+
+  output_sorted_file.close();
+  ClassWriter output_static_file(output_stats_file_name.c_str(), io_backend);
+  if (!output_static_file.is_open()) {
+    perror(("Failed to open " + output_stats_file_name).c_str());
+    exit(1);
+  }
+  output_static_file.printf("Average,Median,Std. Dev\n");
+  output_static_file.printf("%.3lf,%.3lf,%.3lf\n", Average, Median, Std_Dev);
+  output_static_file.close();
+}
+
+// Reader thread: parse the classes in order and hand them to the sorter
+void *reader_stage(void *args) {
+  stage_args *stage = (stage_args *) args;
+  for (size_t i = 0; i < stage->classes.size(); ++i) {
+    class_job *job = new class_job(stage->classes[i]);
+    read_class(job, stage->io_backend);
+    stage->queue->push(job);
+  }
+  return NULL;
+}
+
+// Writer thread: write out every sorted class handed over by the sorter
+void *writer_stage(void *args) {
+  stage_args *stage = (stage_args *) args;
+  for (size_t i = 0; i < stage->classes.size(); ++i) {
+    class_job *job = stage->queue->pop();
+    write_class(job, stage->io_backend);
+    delete job;
+  }
+  return NULL;
+}
+
+
 // This function should be called in each child process right after forking
 // The input vector should be a subset of the original files vector
-void process_classes(vector<string> classes, int num_threads) {
+//
+// The classes go through a three stage pipeline: a reader thread parses class
+// i + 1 while this thread sorts class i and a writer thread writes class i - 1.
+// The queues between the stages hold one class each, which bounds memory to a
+// handful of classes and lets the disk and the sort threads work at once.
+void process_classes(vector<string> classes, int num_threads, const p1_options &options) {
   printf("Child process is created. (pid: %d)\n", getpid());
   // Each process should use the sort function which you have defined  		
   // in the p1_threads.cpp for multithread sorting of the data. 
@@ -28,108 +168,52 @@ void process_classes(vector<string> classes, int num_threads) {
   }
   printf("\n");
 
+  // The topology is read once per child and shared by the sorts of all its classes
+  NumaTopology *numa = NULL;
+  if (options.numa_nodes > 0) {
+    numa = new NumaTopology(options.numa_nodes);
+    printf("NUMA placement over %d node(s). (pid: %d)\n", numa->num_nodes(), getpid());
+  }
 
-  for (int i = 0; i < classes.size(); i++) {
-    // get all the input/output file names here
-    string class_name = classes[i];
-    char buffer[40];
-
-    sprintf(buffer, "input/%s.csv", class_name.c_str());
-    string input_file_name(buffer);
-
-    sprintf(buffer, "output/%s_sorted.csv", class_name.c_str());
-    string output_sorted_file_name(buffer);
-
-    sprintf(buffer, "output/%s_stats.csv", class_name.c_str());
-    string output_stats_file_name(buffer);
-
-    vector<student> students;
-    // Your implementation goes here, you will need to implement:
-    // File I/O
-    //  - This means reading the input file, and creating a list of students,
-    //  see p1_process.h for the definition of the student struct
-    //
-    FILE* input_file = fopen(input_file_name.c_str(), "r");
-    // Read Header
-    char header[128];
-    fgets(header, sizeof(header), input_file);
-
-    // Read Each line data
-    char line[128];
-    while (fgets(line, sizeof(line), input_file)) {
-        unsigned long id;
-        double score;
-
-        if (sscanf(line, "%lu,%lf", &id, &score) == 2) {
-            student s(id,score);
-            students.push_back(s);
-        }
-    }
-    fclose(input_file);
-    printf("%s, student amount: %ld \n",class_name.c_str(), students.size());
-  
-    
-    //  - Also, once the sorting is done and the statistics are generated, this means
-    //  creating the appropritate output files
-    //
-    // Multithreaded Sorting
-    //  - See p1_thread.cpp and p1_thread.h
-    //
-    //  - The code to run the sorter has already been provided
-    //
-    // Generating Statistics
-    //  - This can be done after sorting or during
-
-    // Run multi threaded sort
-    ParallelMergeSorter sorter(students, num_threads);
-    vector<student> sorted = sorter.run_sort();
-    //vector<student> sorted = students;
-
-    double Average = 0.0;
-    double Median = 0.0;
-    double Variance = 0.0;
-    double Std_Dev = 0.0;
-    double Temp_sum = 0.0;
-
-    FILE* output_sorted_file = fopen(output_sorted_file_name.c_str(), "w");
-    if (!output_sorted_file) {
-      perror(("Failed to open " + output_sorted_file_name).c_str());
-      exit(1);
-    }
+  if (options.io_backend != IO_STDIO) {
+    printf("Class file I/O backend: %s. (pid: %d)\n", io_backend_name(options.io_backend), getpid());
+  }
 
-    fprintf(output_sorted_file, "Rank,Student ID,Grade\n");
-    int students_size = sorted.size();
+  BoundedQueue<class_job *> parsed(1);
+  BoundedQueue<class_job *> sorted(1);
 
-    int n = 0;
-    double M2 = 0.0;
+  stage_args reader_args;
+  reader_args.classes = classes;
+  reader_args.queue = &parsed;
+  reader_args.io_backend = options.io_backend;
 
-    for (int i = 0; i< students_size;i++){
-      const student &s = sorted[i];
-      fprintf(output_sorted_file, "%d,%lu,%lf \n", (i+1), s.id, s.grade);
-      
-      n++;
-
-      double delta = s.grade - Average;
-      Average += delta / n;
-      M2 += delta * (s.grade - Average);  // Welford's update
-    }
+  stage_args writer_args;
+  writer_args.classes = classes;
+  writer_args.queue = &sorted;
+  writer_args.io_backend = options.io_backend;
 
+  pthread_t reader_thread, writer_thread;
+  if (pthread_create(&reader_thread, NULL, reader_stage, &reader_args) != 0 ||
+      pthread_create(&writer_thread, NULL, writer_stage, &writer_args) != 0) {
+    printf("thread_create \n");
+    exit(1);
+  }
 
-    if (students_size % 2 == 0) {
-      Median = (sorted[students_size / 2 - 1].grade + sorted[students_size / 2].grade) / 2.0;
-    } else {
-      Median = sorted[students_size / 2].grade;
-    }
-    Std_Dev = sqrt(M2 / students_size); 
+  // Stage 2: sort on this thread
+  for (size_t i = 0; i < classes.size(); i++) {
+    class_job *job = parsed.pop();
 
-    fclose(output_sorted_file);
-    FILE* output_static_file = fopen(output_stats_file_name.c_str(), "w");
-    fprintf(output_static_file, "Average,Median,Std. Dev\n");
-    fprintf(output_static_file, "%.3lf,%.3lf,%.3lf\n", Average, Median, Std_Dev);
-    fclose(output_static_file);
+    // Run multi threaded sort
+    ParallelMergeSorter sorter(job->students, num_threads, numa);
+    job->students = sorter.run_sort();
 
+    sorted.push(job);
   }
 
+  pthread_join(reader_thread, NULL);
+  pthread_join(writer_thread, NULL);
+  delete numa;
+
   // child process done, exit the program
   printf("Child process is terminated. (pid: %d)\n", getpid());
   exit(0);
@@ -137,7 +221,7 @@ void process_classes(vector<string> classes, int num_threads) {
 
 //num_processes : number of child process
 
-void create_processes_and_sort(vector<string> class_names, int num_processes, int num_threads) {
+void create_processes_and_sort(vector<string> class_names, int num_processes, int num_threads, const p1_options &options) {
   vector<pid_t> child_pids;
   
   vector<string> classes_sublist;
@@ -197,7 +281,7 @@ void create_processes_and_sort(vector<string> class_names, int num_processes, in
         exit(1);
     } else if (pid == 0) {
         // Child process: handle its own sublist
-        process_classes(sublist, num_threads);
+        process_classes(sublist, num_threads, options);
         exit(0);  // Child process exits after completion
     } else {
         // Parent process: record PID
@@ -14,6 +14,19 @@ struct student {
   }
 };
 
-void create_processes_and_sort(std::vector<std::string>, int, int);
+// Optional settings given on the command line, shared by every child process
+struct p1_options {
+  // 0 = no NUMA placement, otherwise the number of (possibly simulated) nodes
+  int numa_nodes;
+  // Backend for the class files, see io_backend in p1_io.h
+  int io_backend;
+
+  p1_options() {
+    this->numa_nodes = 0;
+    this->io_backend = 0;
+  }
+};
+
+void create_processes_and_sort(std::vector<std::string>, int, int, const p1_options &);
 
 #endif
@@ -3,6 +3,8 @@
 #include <cstring>
 #include <string>
 #include <cstdlib>
+#include <new>
+#include <sys/mman.h>
   
 #include "p1_process.h"
 #include "p1_threads.h"
@@ -24,12 +26,51 @@ struct MergeSortArgs {
     }
   };
 
+// Arguments of a per-node merge thread: the boundaries of the sorted slices of one node
+struct NodeMergeArgs {
+    int node;
+    std::vector<int> boundaries;
+    ParallelMergeSorter * ctx;
+
+    NodeMergeArgs(ParallelMergeSorter * ctx, int node, const int * boundaries, int segments) {
+      this->ctx = ctx;
+      this->node = node;
+      this->boundaries = std::vector<int>(boundaries, boundaries + segments + 1);
+    }
+  };
+
 
 // Class constructor
-ParallelMergeSorter::ParallelMergeSorter(vector<student> &original_list, int num_threads) {
+ParallelMergeSorter::ParallelMergeSorter(vector<student> &original_list, int num_threads, const NumaTopology * numa) {
   this->threads = vector<pthread_t>();
-  this->sorted_list = vector<student>(original_list);
   this->num_threads = num_threads;
+  this->numa = numa;
+  this->list = NULL;
+  this->list_size = original_list.size();
+  this->source = original_list.empty() ? NULL : &original_list[0];
+
+  if (numa != NULL && list_size > 0) {
+    // Only reserve the pages here, each worker first-touches its own slice on its node
+    void * buffer = mmap(NULL, list_size * sizeof(student), PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buffer == MAP_FAILED) {
+      perror("mmap");
+      exit(1);
+    }
+    this->list = (student *) buffer;
+  } else {
+    this->numa = NULL;
+    this->sorted_list = vector<student>(original_list);
+    if (list_size > 0) {
+      this->list = &sorted_list[0];
+    }
+  }
+}
+
+ParallelMergeSorter::~ParallelMergeSorter() {
+  if (numa != NULL) {
+    munmap(list, list_size * sizeof(student));
+  }
 }
 
 // This function will be called by each child process to perform multithreaded sorting
@@ -70,6 +111,9 @@ vector<student> ParallelMergeSorter::run_sort()
     // sort the output of threads
     merge_threads();
 
+    if (numa != NULL) {
+        return vector<student>(list, list + list_size);
+    }
     return sorted_list;
 }
 
@@ -93,7 +137,7 @@ void ParallelMergeSorter::merge(int lower, int middle, int upper){
     // Your implementation goes here, you will need to implement:
     // Merge for top-down merge sort
     //  - The merge results should go in temporary list, and once the merge is done, the values
-    //  from the temporary list should be copied back into this->sorted_list
+    //  from the temporary list should be copied back into this->list
     
     int merge_size = upper - lower;
     vector<student> temp;
@@ -101,8 +145,8 @@ void ParallelMergeSorter::merge(int lower, int middle, int upper){
 
     int i = lower, j = middle;
     while (i < middle && j < upper) {
-        const student &a = sorted_list[i];
-        const student &b = sorted_list[j];
+        const student &a = list[i];
+        const student &b = list[j];
     
         if (a.grade > b.grade || (a.grade == b.grade))
         {
@@ -114,38 +158,22 @@ void ParallelMergeSorter::merge(int lower, int middle, int upper){
         }
     }
     while (i < middle) {
-        temp.push_back(sorted_list[i++]);
+        temp.push_back(list[i++]);
     }
     while (j < upper) {
-        temp.push_back(sorted_list[j++]);
+        temp.push_back(list[j++]);
     }
 
     for (int k = 0; k < merge_size; ++k){
-        sorted_list[lower + int(k)] = temp[k];
+        list[lower + int(k)] = temp[k];
     }
 
 }
 
-// This function will be used to merge the resulting sorted sublists together
-void ParallelMergeSorter::merge_threads(){
-    // Your implementation goes here, you will need to implement:
-    // Merging the sorted sublists together
-    //  - Each worker thread only sorts a subset of the entire list, therefore once all
-    //  worker threads are done, we are left with multiple sorted sublists which then need to
-    //  be merged once again to result in one total sorted list
-    int array_length = (int)sorted_list.size();
-    
-    int* boundaries = new int[num_threads + 1];
-    
-    int work_per_thread = array_length / num_threads;
-
-
-    for (int i = 0; i < num_threads; ++i) {
-        boundaries[i] = i * work_per_thread;
-    }
-    boundaries[num_threads] = array_length;
-    
-    int current_segments = num_threads;
+// Pairwise merge of adjacent sorted segments [boundaries[i], boundaries[i + 1])
+// until one segment is left. The boundaries array is used as scratch space.
+void ParallelMergeSorter::merge_segments(int* boundaries, int segments){
+    int current_segments = segments;
     
     while (current_segments > 1) {
         int new_segments = 0;
@@ -168,9 +196,80 @@ void ParallelMergeSorter::merge_threads(){
         boundaries[new_segments] = boundaries[current_segments];
         current_segments = new_segments;
     }
+}
+
+// This function will be used to merge the resulting sorted sublists together
+void ParallelMergeSorter::merge_threads(){
+    // Your implementation goes here, you will need to implement:
+    // Merging the sorted sublists together
+    //  - Each worker thread only sorts a subset of the entire list, therefore once all
+    //  worker threads are done, we are left with multiple sorted sublists which then need to
+    //  be merged once again to result in one total sorted list
+    int array_length = list_size;
+    
+    int* boundaries = new int[num_threads + 1];
     
+    int work_per_thread = array_length / num_threads;
+
+
+    for (int i = 0; i < num_threads; ++i) {
+        boundaries[i] = i * work_per_thread;
+    }
+    boundaries[num_threads] = array_length;
+
+    if (numa == NULL || numa->num_nodes() == 1) {
+        merge_segments(boundaries, num_threads);
+        delete[] boundaries;
+        return;
+    }
+
+    // NUMA placement: the slices of one node are adjacent, so merge them on a thread
+    // pinned to that node first, then merge the per-node runs
+    int* node_boundaries = new int[num_threads + 1];
+    int node_segments = 0;
+    vector<pthread_t> node_threads;
+
+    int first = 0;
+    while (first < num_threads) {
+        int node = numa->node_of_thread(first, num_threads);
+        int last = first;
+        while (last < num_threads && numa->node_of_thread(last, num_threads) == node) {
+            ++last;
+        }
+        node_boundaries[node_segments++] = boundaries[first];
+
+        NodeMergeArgs *args = new NodeMergeArgs(this, node, boundaries + first, last - first);
+        pthread_t tid;
+        int ret = pthread_create(&tid, NULL, node_merge_init, args);
+        if (ret != 0) {
+            printf("thread_create \n");
+            exit(1);
+        }
+        node_threads.push_back(tid);
+        first = last;
+    }
+    node_boundaries[node_segments] = array_length;
+
+    for (size_t i = 0; i < node_threads.size(); ++i)
+        pthread_join(node_threads[i], NULL);
+
+    merge_segments(node_boundaries, node_segments);
+
+    delete[] node_boundaries;
     delete[] boundaries;
 }
+
+// Start routine of the per-node merge threads used with NUMA placement
+void *ParallelMergeSorter::node_merge_init(void *args){
+    NodeMergeArgs * merge_args = (NodeMergeArgs *) args;
+    ParallelMergeSorter * ctx = merge_args->ctx;
+
+    ctx->numa->pin_current_thread(ctx->numa->first_cpu_of_node(merge_args->node));
+    ctx->merge_segments(&merge_args->boundaries[0], merge_args->boundaries.size() - 1);
+
+    delete merge_args;
+    return NULL;
+}
 // This function is the start routine for the created threads, it should perform merge sort on its assigned sublist
 // Since this function is static (pthread_create must take a static function), we cannot access "this" and must use ctx instead
 void *ParallelMergeSorter::thread_init(void *args){
@@ -178,7 +277,7 @@ void *ParallelMergeSorter::thread_init(void *args){
     int thread_index = sort_args->thread_index;
     ParallelMergeSorter * ctx = sort_args->ctx;
   
-    int work_per_thread = ctx->sorted_list.size() / ctx->num_threads;
+    int work_per_thread = ctx->list_size / ctx->num_threads;
  
     printf("Thread Index:%d \n", thread_index);
 
@@ -194,7 +293,7 @@ void *ParallelMergeSorter::thread_init(void *args){
     int lower = (thread_index) * work_per_thread;
     int upper;
     if (thread_index == (ctx->num_threads - 1)) {
-        upper = ctx->sorted_list.size();
+        upper = ctx->list_size;
     } else {
         upper = (thread_index + 1) * work_per_thread;
     }
@@ -209,6 +308,17 @@ void *ParallelMergeSorter::thread_init(void *args){
     //
     //  - It may make sense to equivalate this function as the non recursive "helper function" that merge sort normally has
 
+    // With NUMA placement, run on a core of this slice's node and first-touch the
+    // slice from there so the sort works on node-local memory
+    if (ctx->numa != NULL) {
+        int node = ctx->numa->node_of_thread(thread_index, ctx->num_threads);
+        ctx->numa->pin_current_thread(ctx->numa->cpu_of_thread(thread_index, ctx->num_threads));
+        ctx->numa->bind_memory(ctx->list + lower, (upper - lower) * sizeof(student), node);
+        for (int i = lower; i < upper; ++i) {
+            new (ctx->list + i) student(ctx->source[i]);
+        }
+    }
+
     // Free the heap allocation
 
     ctx->merge_sort(lower, upper);
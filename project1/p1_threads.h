@@ -5,6 +5,7 @@
 #include <pthread.h>
 
 #include "p1_process.h"
+#include "p1_numa.h"
 
 // Class to handle multithreaded merge sort
 class ParallelMergeSorter {
@@ -13,13 +14,26 @@ class ParallelMergeSorter {
     std::vector<student> sorted_list;
     int num_threads;
 
+    // Storage being sorted: sorted_list, or a NUMA placed buffer filled from source
+    student * list;
+    int list_size;
+    const student * source;
+    const NumaTopology * numa;
+
     static void * thread_init(void *);
+    static void * node_merge_init(void *);
 
     void merge_sort(int, int);
     void merge(int, int, int);
+    void merge_segments(int *, int);
     void merge_threads();
+
+    // Owns the NUMA buffer and list may point into sorted_list: not copyable
+    ParallelMergeSorter(const ParallelMergeSorter &);
+    ParallelMergeSorter & operator=(const ParallelMergeSorter &);
   public:
-    ParallelMergeSorter(std::vector<student> &, int);
+    ParallelMergeSorter(std::vector<student> &, int, const NumaTopology * numa = NULL);
+    ~ParallelMergeSorter();
 
     std::vector<student> run_sort();
 };
@@ -0,0 +1,93 @@
+#include "arrival_trace.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+using namespace std;
+
+// --- ArrivalTrace ---
+
+ArrivalTrace::~ArrivalTrace() {
+    if (data) munmap(const_cast<char*>(data), size);
+}
+
+bool ArrivalTrace::fail(const string& what) {
+    message = what;
+    pos = size;     // nothing more to read
+    return false;
+}
+
+bool ArrivalTrace::open(const string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return fail("cannot open " + path + ": " + strerror(errno));
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return fail("cannot stat " + path + ": " + strerror(errno));
+    }
+    size = st.st_size;
+    if (size > 0) {
+        void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            ::close(fd);
+            size = 0;
+            return fail("cannot map " + path + ": " + strerror(errno));
+        }
+        // Read once front to back, let the kernel read ahead and drop pages behind
+        madvise(map, size, MADV_SEQUENTIAL);
+        data = static_cast<const char*>(map);
+    }
+    ::close(fd);    // the mapping stays valid
+    return true;
+}
+
+// Parse a non-negative integer at pos, false if there is none
+static bool parse_int(const char* data, size_t size, size_t& pos, int& value) {
+    size_t start = pos;
+    long long v = 0;
+    while (pos < size && data[pos] >= '0' && data[pos] <= '9') {
+        v = v * 10 + (data[pos] - '0');
+        if (v > 2147483647LL) return false;
+        ++pos;
+    }
+    value = (int)v;
+    return pos > start;
+}
+
+bool ArrivalTrace::next(int& arrival, int& question_time) {
+    while (pos < size) {
+        ++line;
+        size_t end = pos;
+        while (end < size && data[end] != '\n') ++end;
+        size_t p = pos;
+        size_t row_end = end;
+        pos = end + 1;
+
+        while (p < row_end && (data[p] == ' ' || data[p] == '\t')) ++p;
+        if (p == row_end || data[p] == '#' || data[p] == '\r') continue;
+        // A header names the columns instead of holding numbers
+        if (line == 1 && (data[p] < '0' || data[p] > '9')) continue;
+
+        if (!parse_int(data, row_end, p, arrival)) {
+            return fail("line " + to_string(line) + ": expected an arrival time");
+        }
+        while (p < row_end && (data[p] == ' ' || data[p] == '\t')) ++p;
+        if (p == row_end || data[p] != ',') {
+            return fail("line " + to_string(line) + ": expected a comma after the arrival time");
+        }
+        ++p;
+        while (p < row_end && (data[p] == ' ' || data[p] == '\t')) ++p;
+        if (!parse_int(data, row_end, p, question_time) || question_time < 1) {
+            return fail("line " + to_string(line) + ": expected a question time of at least 1");
+        }
+        if (arrival < last_arrival) {
+            return fail("line " + to_string(line) + ": arrivals are not sorted by time");
+        }
+        last_arrival = arrival;
+        return true;
+    }
+    return false;
+}
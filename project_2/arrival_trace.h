@@ -0,0 +1,43 @@
+#ifndef ARRIVAL_TRACE_H
+#define ARRIVAL_TRACE_H
+
+#include <cstddef>
+#include <string>
+
+// Recorded arrivals read straight out of a memory-mapped CSV file.
+//
+// One row per visit: "arrival,question_time" in whole minutes, further
+// columns are ignored. Rows must be sorted by arrival time; blank lines,
+// # comments and a header line are skipped. Rows are parsed in place as the
+// simulation asks for them, so replaying a trace of any length needs no
+// more memory than the pages the kernel keeps mapped.
+class ArrivalTrace {
+    private:
+        const char* data = nullptr;
+        size_t size = 0;
+        size_t pos  = 0;
+        long line   = 0;
+        int last_arrival = 0;
+        std::string message;
+
+        bool fail(const std::string& what);
+
+    public:
+        ArrivalTrace() {}
+        ~ArrivalTrace();
+        ArrivalTrace(const ArrivalTrace&) = delete;
+        ArrivalTrace& operator=(const ArrivalTrace&) = delete;
+
+        bool open(const std::string& path);
+
+        // Next row. Returns false at the end of the trace or on a bad row.
+        bool next(int& arrival, int& question_time);
+
+        // Most rows the file can hold, a row being at least "a,q\n"
+        long long maxRows() const { return size / 4 + 1; }
+
+        // Why open() or next() failed, empty at a clean end of file
+        const std::string& error() const { return message; }
+};
+
+#endif // ARRIVAL_TRACE_H
@@ -0,0 +1,241 @@
+#include "batch.h"
+#include "event_sim.h"
+#include "simulation.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/* ========= Batch Specification ========= */
+struct BatchSpec {
+    vector<int> chairs{3};
+    vector<int> students{10};
+    vector<int> tas{1};
+    vector<int> minutes{60};
+    vector<QuestionDist> questions{QuestionDist()};
+    vector<DispatchSpec> policies{DispatchSpec()};
+    unsigned long seed = 1;
+    int jobs = 0;           // 0: one per core
+    string out;             // empty: standard output
+};
+
+// "1,2,4" or "10-100:10" (ranges and values can be mixed)
+static bool parseIntList(const string& text, vector<int>& values) {
+    values.clear();
+    stringstream ss(text);
+    string item;
+    while (getline(ss, item, ',')) {
+        int first, last, step = 1;
+        char c;
+        istringstream is(item);
+        if (!(is >> first)) return false;
+        last = first;
+        if (is >> c) {
+            if (c != '-' || !(is >> last)) return false;
+            if (is >> c && (c != ':' || !(is >> step) || step < 1)) return false;
+        }
+        for (int v = first; v <= last; v += step) {
+            values.push_back(v);
+            if (v > last - step) break;     // v + step would pass last, or overflow
+        }
+    }
+    return !values.empty();
+}
+
+static bool applyOption(BatchSpec& spec, const string& key, const string& value);
+
+// key=value lines, blank lines and # comments are skipped
+static bool readConfig(BatchSpec& spec, const string& path) {
+    ifstream in(path);
+    if (!in.is_open()) {
+        cerr << "Failed to open " << path << endl;
+        return false;
+    }
+    string line;
+    int line_no = 0;
+    while (getline(in, line)) {
+        ++line_no;
+        line = line.substr(0, line.find('#'));
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == string::npos) continue;
+        size_t eq = line.find('=');
+        if (eq == string::npos) {
+            cerr << path << ":" << line_no << ": expected key=value" << endl;
+            return false;
+        }
+        string key   = line.substr(first, eq - first);
+        string value = line.substr(eq + 1);
+        key.erase(key.find_last_not_of(" \t") + 1);
+        value.erase(0, value.find_first_not_of(" \t"));
+        value.erase(value.find_last_not_of(" \t\r") + 1);
+        if (!applyOption(spec, key, value)) {
+            cerr << path << ":" << line_no << ": bad value for " << key << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool applyOption(BatchSpec& spec, const string& key, const string& value) {
+    if (key == "chairs")   return parseIntList(value, spec.chairs);
+    if (key == "students") return parseIntList(value, spec.students);
+    if (key == "tas")      return parseIntList(value, spec.tas);
+    if (key == "minutes")  return parseIntList(value, spec.minutes);
+    if (key == "question") {
+        spec.questions.clear();
+        stringstream ss(value);
+        string item;
+        while (getline(ss, item, ',')) {
+            QuestionDist dist;
+            if (!dist.parse(item)) return false;
+            spec.questions.push_back(dist);
+        }
+        return !spec.questions.empty();
+    }
+    if (key == "policy") {
+        spec.policies.clear();
+        stringstream ss(value);
+        string item;
+        while (getline(ss, item, ',')) {
+            DispatchSpec policy;
+            if (!policy.parse(item)) return false;
+            spec.policies.push_back(policy);
+        }
+        return !spec.policies.empty();
+    }
+    if (key == "seed") {
+        spec.seed = strtoul(value.c_str(), nullptr, 10);
+        return true;
+    }
+    if (key == "jobs") {
+        spec.jobs = atoi(value.c_str());
+        return spec.jobs > 0;
+    }
+    if (key == "out") {
+        spec.out = value;
+        return true;
+    }
+    if (key == "config") return readConfig(spec, value);
+    return false;
+}
+
+static void printBatchUsage(const char* program) {
+    cerr << "Usage: " << program << " --batch [--config=FILE] [--chairs=LIST] [--students=LIST] [--tas=LIST]\n"
+         << "                 [--minutes=LIST] [--question=DIST,...] [--policy=P,...] [--seed=S] [--jobs=N] [--out=FILE]\n"
+         << "  LIST is comma separated values or ranges FIRST-LAST[:STEP]\n"
+         << "  DIST is uniform:LOW-HIGH or exp:MEAN (minutes per question)\n"
+         << "  P is fifo, sqf, priority:QUICK or rr:QUANTUM (hallway dispatch policy)\n";
+}
+
+/* ========= Batch Run ========= */
+int run_batch(int argc, char* argv[]) {
+    BatchSpec spec;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        size_t eq = arg.find('=');
+        if (arg == "--batch") continue;
+        if (arg.compare(0, 2, "--") != 0 || eq == string::npos ||
+            !applyOption(spec, arg.substr(2, eq - 2), arg.substr(eq + 1))) {
+            cerr << "Invalid batch option: " << arg << "\n";
+            printBatchUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    // Every combination of the parameter lists
+    vector<SimConfig> grid;
+    for (int c : spec.chairs)
+        for (int n : spec.students)
+            for (int t : spec.tas)
+                for (int m : spec.minutes)
+                    for (const auto& q : spec.questions)
+                        for (const auto& p : spec.policies) {
+                            SimConfig config;
+                            config.chairs   = c;
+                            config.students = n;
+                            config.ta_count = t;
+                            config.minutes  = m;
+                            config.question = q;
+                            config.policy   = p;
+                            grid.push_back(config);
+                        }
+    for (const auto& config : grid) {
+        if (config.chairs < 0 || config.students < 0 || config.ta_count < 1 || config.minutes < 0) {
+            cerr << "Chairs, students and minutes must not be negative and there must be at least one TA\n";
+            return 1;
+        }
+    }
+
+    // Stream i of the seed for configuration i, each one jump past the last
+    vector<Xoshiro256> streams;
+    streams.reserve(grid.size());
+    Xoshiro256 stream(spec.seed);
+    for (size_t i = 0; i < grid.size(); ++i) {
+        streams.push_back(stream);
+        stream.jump();
+    }
+
+    // Independent simulations, handed out to the workers one at a time
+    vector<SimResult> results(grid.size());
+    atomic<size_t> next_config{0};
+    auto worker = [&]() {
+        size_t i;
+        while ((i = next_config++) < grid.size()) {
+            const SimConfig& config = grid[i];
+            Xoshiro256 engine = streams[i];
+            vector<Student> students = makeStudents(config, engine);
+            RunStats stats(max(config.minutes, 1), config.ta_count);
+            for (auto& s : students) s.attachStats(&stats);
+            EventSimulator simulator(students, config.chairs, config.minutes, config.ta_count,
+                                     engine, nullptr, false, &stats, config.policy);
+            simulator.run();
+            results[i] = summarize(config.students, stats, simulator.getNapTime());
+        }
+    };
+
+    int jobs = spec.jobs > 0 ? spec.jobs : (int)thread::hardware_concurrency();
+    if (jobs < 1) jobs = 1;
+    if ((size_t)jobs > grid.size()) jobs = grid.size();
+    vector<thread> threads;
+    for (int j = 0; j < jobs; ++j) threads.emplace_back(worker);
+    for (auto& th : threads) th.join();
+
+    // One CSV row per configuration, in grid order
+    ofstream file;
+    if (!spec.out.empty()) {
+        file.open(spec.out);
+        if (!file.is_open()) {
+            cerr << "Failed to open " << spec.out << endl;
+            return 1;
+        }
+    }
+    ostream& out = spec.out.empty() ? cout : file;
+    out << "config,chairs,students,tas,minutes,question,seed,helped,not_helped,"
+           "avg_question,avg_wait,max_wait,avg_turnaround,max_turnaround,ta_nap_time,avg_ta_nap_time,"
+           "p50_wait,p90_wait,p99_wait,p99_turnaround,policy\n";
+    out << fixed << setprecision(3);
+    for (size_t i = 0; i < grid.size(); ++i) {
+        const SimConfig& c = grid[i];
+        const SimResult& r = results[i];
+        out << i << ',' << c.chairs << ',' << c.students << ',' << c.ta_count << ',' << c.minutes << ','
+            << c.question.describe() << ',' << spec.seed << ','
+            << r.helped << ',' << r.students - r.helped << ','
+            << r.avg_question << ',' << r.avg_wait << ',' << r.max_wait << ','
+            << r.avg_turnaround << ',' << r.max_turnaround << ','
+            << r.ta_nap_time << ',' << (double)r.ta_nap_time / c.ta_count << ','
+            << r.p50_wait << ',' << r.p90_wait << ',' << r.p99_wait << ',' << r.p99_turnaround << ','
+            << c.policy.describe() << '\n';
+    }
+    if (!spec.out.empty()) {
+        cerr << grid.size() << " configurations written to " << spec.out << endl;
+    }
+    return 0;
+}
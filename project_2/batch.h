@@ -0,0 +1,16 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+// Headless batch mode: runs every combination of the given parameter lists as
+// an independent event-driven simulation, spread over all cores, and writes
+// one CSV row of statistics per combination.
+//
+// Options (also accepted as key=value lines in a --config file, # comments):
+//   --chairs=LIST  --students=LIST  --tas=LIST  --minutes=LIST
+//   --question=DIST[,DIST...]   DIST is uniform:LOW-HIGH or exp:MEAN
+//   --policy=P[,P...]           P is fifo, sqf, priority:QUICK or rr:QUANTUM
+//   --seed=S  --jobs=N  --out=FILE  --config=FILE
+// A LIST is comma separated values or ranges FIRST-LAST[:STEP], e.g. 1,2,4 or 10-100:10.
+int run_batch(int argc, char* argv[]);
+
+#endif // BATCH_H
@@ -0,0 +1,120 @@
+#include <sys/resource.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "helper.h"
+#include "event_sim.h"
+#include "simulation.h"
+#include "stats.h"
+#include "thread_sim.h"
+
+using namespace std;
+
+// Scaling benchmark of the simulator core. Runs the threaded and the
+// event-driven engine headless at 10, 100, ... students and prints one row
+// per run: wall time, simulated ticks and logged events per second, peak
+// resident set size so far, and how often threads ran into each other.
+
+/* ========= Options ========= */
+struct BenchOptions {
+    int max_students = 1000000;
+    int minutes      = 1000;
+    int workers      = 0;       // 0: one per core
+    bool threads     = true;
+    bool event       = true;
+};
+
+static long peak_rss_kb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;     // kilobytes on Linux
+}
+
+static void print_row(const char* engine, const SimConfig& config, int workers, double seconds,
+                      unsigned long long events, unsigned long long lock_waits, unsigned long long hall_retries) {
+    cout << left << setw(8) << engine << right
+         << setw(9) << config.students << setw(6) << config.ta_count << setw(8) << config.chairs
+         << setw(8) << workers << setw(10) << fixed << setprecision(3) << seconds
+         << setw(12) << setprecision(0) << config.minutes / seconds
+         << setw(13) << events / seconds
+         << setw(10) << setprecision(1) << peak_rss_kb() / 1024.0
+         << setw(11) << lock_waits << setw(11) << hall_retries << endl;
+}
+
+/* ========= Main Function ========= */
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--max-students=", 15) == 0 && atoi(argv[i] + 15) > 0) {
+            options.max_students = atoi(argv[i] + 15);
+        } else if (strncmp(argv[i], "--minutes=", 10) == 0 && atoi(argv[i] + 10) > 0) {
+            options.minutes = atoi(argv[i] + 10);
+        } else if (strncmp(argv[i], "--workers=", 10) == 0 && atoi(argv[i] + 10) > 0) {
+            options.workers = atoi(argv[i] + 10);
+        } else if (strcmp(argv[i], "--engine=threads") == 0) {
+            options.event = false;
+        } else if (strcmp(argv[i], "--engine=event") == 0) {
+            options.threads = false;
+        } else {
+            cout << "Usage: " << argv[0] << " [--max-students=N] [--minutes=M] [--workers=N] [--engine=threads|event]\n";
+            return 1;
+        }
+    }
+    int workers = options.workers > 0 ? options.workers : (int)thread::hardware_concurrency();
+    if (workers < 1) workers = 1;
+
+    cout << left << setw(8) << "engine" << right
+         << setw(9) << "students" << setw(6) << "tas" << setw(8) << "chairs"
+         << setw(8) << "workers" << setw(10) << "seconds"
+         << setw(12) << "ticks/s" << setw(13) << "events/s"
+         << setw(10) << "rss_MB" << setw(11) << "lock_waits" << setw(11) << "cas_retry" << endl;
+
+    seedRandomTime(1);
+    for (long long n = 10; n <= options.max_students; n *= 10) {
+        // Staff and seat the office in proportion to the crowd
+        SimConfig config;
+        config.students = n;
+        config.minutes  = options.minutes;
+        config.ta_count = max<long long>(1, n / 1000);
+        config.chairs   = max<long long>(3, n / 100);
+
+        if (options.threads) {
+            Xoshiro256 student_rng = randomStream(0);
+            RunStats stats(config.minutes, config.ta_count);
+            StudentStore students(config.students, config.minutes, &stats);
+            makeStudents(config, student_rng, students);
+            vector<TAStats> ta_stats;
+            ThreadSimOptions thread_options;
+            thread_options.ta_count = config.ta_count;
+            thread_options.workers  = workers;
+            thread_options.log      = nullptr;
+            ThreadSimCounters counters;
+
+            auto start = chrono::steady_clock::now();
+            run_thread_simulation(students, config.chairs, config.minutes, thread_options, stats, ta_stats, &counters);
+            chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+            print_row("threads", config, workers, elapsed.count(),
+                      counters.events, counters.lock_waits, counters.hall_retries);
+        }
+
+        if (options.event) {
+            Xoshiro256 student_rng = randomStream(0);
+            vector<Student> students = makeStudents(config, student_rng);
+            Xoshiro256 retry_rng = randomStream(1);
+
+            auto start = chrono::steady_clock::now();
+            EventSimulator simulator(students, config.chairs, config.minutes, config.ta_count,
+                                     retry_rng, nullptr, false);
+            simulator.run();
+            chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+            print_row("event", config, 1, elapsed.count(), simulator.getEventCount(), 0, 0);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,22 @@
+#ifndef CACHE_ALIGNED_H
+#define CACHE_ALIGNED_H
+
+#include <cstdlib>
+#include <new>
+
+// Base for classes with alignas(64) members that are allocated with new.
+// Before C++17 plain new only guarantees alignof(std::max_align_t), 16 bytes
+// on x86-64, so the members would not really get lines of their own on the
+// heap. Allocating through this base puts the object on a 64-byte boundary.
+struct CacheAligned {
+    static void* operator new(std::size_t size) {
+        void* p = nullptr;
+        if (posix_memalign(&p, 64, size) != 0) throw std::bad_alloc();
+        return p;
+    }
+    static void operator delete(void* p) noexcept {
+        free(p);
+    }
+};
+
+#endif // CACHE_ALIGNED_H
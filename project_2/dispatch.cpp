@@ -0,0 +1,227 @@
+#include "dispatch.h"
+#include "cache_aligned.h"
+#include "hallway_ring.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+
+using namespace std;
+
+// --- DispatchSpec ---
+
+bool DispatchSpec::parse(const string& text) {
+    if (text == "fifo") {
+        kind = FIFO;
+        return true;
+    }
+    if (text == "sqf") {
+        kind = SHORTEST_FIRST;
+        return true;
+    }
+    if (text.compare(0, 9, "priority:") == 0) {
+        int q = atoi(text.c_str() + 9);
+        if (q < 1) return false;
+        kind  = PRIORITY;
+        quick = q;
+        return true;
+    }
+    if (text.compare(0, 3, "rr:") == 0) {
+        int q = atoi(text.c_str() + 3);
+        if (q < 1) return false;
+        kind    = ROUND_ROBIN;
+        quantum = q;
+        return true;
+    }
+    return false;
+}
+
+string DispatchSpec::describe() const {
+    ostringstream ss;
+    switch (kind) {
+        case FIFO:           ss << "fifo"; break;
+        case SHORTEST_FIRST: ss << "sqf"; break;
+        case PRIORITY:       ss << "priority:" << quick; break;
+        case ROUND_ROBIN:    ss << "rr:" << quantum; break;
+    }
+    return ss.str();
+}
+
+// --- Policies ---
+
+// First come, first served on the lock-free ring (whose alignas(64) ends
+// need the aligned allocation)
+class FifoHall : public DispatchPolicy, public CacheAligned {
+    private:
+        HallwayRing ring;
+
+    public:
+        explicit FifoHall(int chairs) : ring(chairs) {}
+
+        bool tryPush(int student, int remaining) override { return ring.tryPush(student, remaining); }
+        // Sessions are never cut short, so nobody comes back. The ring has no
+        // room beyond the chairs: fail loudly rather than lose the student.
+        void requeue(int student, int remaining) override {
+            if (!ring.tryPush(student, remaining)) {
+                cerr << "FIFO hallway: no chair to requeue S" << student << " in" << endl;
+                abort();
+            }
+        }
+        bool tryPop(int& student, int& remaining) override { return ring.tryPop(student, remaining); }
+        int size() const override { return ring.size(); }
+        vector<int> snapshot() const override { return ring.snapshot(); }
+        unsigned long contention() const override { return ring.casRetries(); }
+};
+
+// Base of the policies kept under a mutex
+class LockedHall : public DispatchPolicy {
+    protected:
+        int chairs;
+        mutable mutex lock;
+        mutable atomic<unsigned long> lock_waits{0};
+
+        // Lock, counting the times another thread held the mutex
+        unique_lock<mutex> acquire() const {
+            unique_lock<mutex> guard(lock, try_to_lock);
+            if (!guard.owns_lock()) {
+                lock_waits.fetch_add(1, memory_order_relaxed);
+                guard.lock();
+            }
+            return guard;
+        }
+
+    public:
+        explicit LockedHall(int chairs_) : chairs(max(chairs_, 0)) {}
+        unsigned long contention() const override { return lock_waits.load(memory_order_relaxed); }
+};
+
+// Binary min-heap on (rank, seating order). Shortest question first ranks by
+// the minutes needed; priority classes rank quick questions 0 and the rest 1,
+// first come first served within a class.
+class HeapHall : public LockedHall {
+    private:
+        struct Entry {
+            int rank;
+            unsigned long order;
+            int student;
+            int remaining;
+
+            bool operator>(const Entry& other) const {
+                if (rank != other.rank) return rank > other.rank;
+                return order > other.order;
+            }
+        };
+
+        DispatchSpec spec;
+        vector<Entry> heap;
+        unsigned long seated = 0;   // students ever queued, the next order
+
+        void push(int student, int remaining) {
+            int rank = spec.kind == DispatchSpec::PRIORITY ? (remaining > spec.quick) : remaining;
+            heap.push_back(Entry{rank, seated++, student, remaining});
+            push_heap(heap.begin(), heap.end(), greater<Entry>());
+        }
+
+    public:
+        HeapHall(const DispatchSpec& spec_, int chairs_) : LockedHall(chairs_), spec(spec_) {
+            heap.reserve(chairs);
+        }
+
+        bool tryPush(int student, int remaining) override {
+            unique_lock<mutex> guard = acquire();
+            if ((int)heap.size() >= chairs) return false;
+            push(student, remaining);
+            return true;
+        }
+        void requeue(int student, int remaining) override {
+            unique_lock<mutex> guard = acquire();
+            push(student, remaining);
+        }
+        bool tryPop(int& student, int& remaining) override {
+            unique_lock<mutex> guard = acquire();
+            if (heap.empty()) return false;
+            pop_heap(heap.begin(), heap.end(), greater<Entry>());
+            student   = heap.back().student;
+            remaining = heap.back().remaining;
+            heap.pop_back();
+            return true;
+        }
+        int size() const override {
+            unique_lock<mutex> guard = acquire();
+            return heap.size();
+        }
+        vector<int> snapshot() const override {
+            vector<Entry> sorted;
+            {
+                unique_lock<mutex> guard = acquire();
+                sorted = heap;
+            }
+            sort(sorted.begin(), sorted.end(), [](const Entry& a, const Entry& b) { return b > a; });
+            vector<int> waiting;
+            for (const auto& e : sorted) waiting.push_back(e.student);
+            return waiting;
+        }
+};
+
+// First come, first served, but a session lasts at most one quantum. A
+// student who needs more goes to the back of the line.
+class RoundRobinHall : public LockedHall {
+    private:
+        struct Entry {
+            int student;
+            int remaining;
+        };
+
+        int quantum;
+        deque<Entry> line;
+
+    public:
+        RoundRobinHall(int quantum_, int chairs_) : LockedHall(chairs_), quantum(quantum_) {}
+
+        bool tryPush(int student, int remaining) override {
+            unique_lock<mutex> guard = acquire();
+            if ((int)line.size() >= chairs) return false;
+            line.push_back(Entry{student, remaining});
+            return true;
+        }
+        void requeue(int student, int remaining) override {
+            unique_lock<mutex> guard = acquire();
+            line.push_back(Entry{student, remaining});
+        }
+        bool tryPop(int& student, int& remaining) override {
+            unique_lock<mutex> guard = acquire();
+            if (line.empty()) return false;
+            student   = line.front().student;
+            remaining = line.front().remaining;
+            line.pop_front();
+            return true;
+        }
+        int size() const override {
+            unique_lock<mutex> guard = acquire();
+            return line.size();
+        }
+        vector<int> snapshot() const override {
+            unique_lock<mutex> guard = acquire();
+            vector<int> waiting;
+            for (const auto& e : line) waiting.push_back(e.student);
+            return waiting;
+        }
+        int slice(int remaining) const override { return min(remaining, quantum); }
+};
+
+unique_ptr<DispatchPolicy> makeDispatchPolicy(const DispatchSpec& spec, int chairs, long long students) {
+    if (students < chairs) chairs = students;
+    switch (spec.kind) {
+        case DispatchSpec::SHORTEST_FIRST:
+        case DispatchSpec::PRIORITY:
+            return unique_ptr<DispatchPolicy>(new HeapHall(spec, chairs));
+        case DispatchSpec::ROUND_ROBIN:
+            return unique_ptr<DispatchPolicy>(new RoundRobinHall(spec.quantum, chairs));
+        case DispatchSpec::FIFO:
+            break;
+    }
+    return unique_ptr<DispatchPolicy>(new FifoHall(chairs));
+}
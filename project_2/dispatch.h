@@ -0,0 +1,57 @@
+#ifndef DISPATCH_H
+#define DISPATCH_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// Which waiting student a free TA takes next
+struct DispatchSpec {
+    enum Kind { FIFO, SHORTEST_FIRST, PRIORITY, ROUND_ROBIN };
+
+    Kind kind   = FIFO;
+    int quick   = 2;    // priority: questions up to this many minutes go first
+    int quantum = 2;    // round robin: minutes of help per visit to the office
+
+    // "fifo", "sqf", "priority:QUICK" or "rr:QUANTUM"
+    bool parse(const std::string& text);
+    std::string describe() const;
+};
+
+// The hallway chairs together with the order students leave them in.
+//
+// Every student is queued with the minutes of help they still need. A policy
+// may cut a help session short (slice); the TA then sends the student back
+// with requeue and they wait again for the rest of their question.
+//
+// All policies are safe to share between threads. FIFO is the lock-free
+// HallwayRing; the others keep a heap or deque under a mutex.
+class DispatchPolicy {
+    public:
+        virtual ~DispatchPolicy() {}
+
+        // Take a chair. Returns false if every chair is taken.
+        virtual bool tryPush(int student, int remaining) = 0;
+        // Back from a cut-short session. The student keeps a place even if
+        // the chairs have filled up meanwhile.
+        virtual void requeue(int student, int remaining) = 0;
+        // Take the next student. Returns false if the hall is empty.
+        virtual bool tryPop(int& student, int& remaining) = 0;
+
+        // Students currently waiting. Only exact while nobody pushes or pops.
+        virtual int size() const = 0;
+        // Waiting students in the order they would be taken. Only call while
+        // nobody pushes or pops, e.g. between ticks.
+        virtual std::vector<int> snapshot() const = 0;
+
+        // Minutes of help one session gives a student needing remaining
+        virtual int slice(int remaining) const { return remaining; }
+        // Failed CAS or contended locks, for benchmarks
+        virtual unsigned long contention() const = 0;
+};
+
+// At most students can wait at once, so the hall allocates room for no more
+// than that many of the chairs; the rest could never be sat on
+std::unique_ptr<DispatchPolicy> makeDispatchPolicy(const DispatchSpec& spec, int chairs, long long students);
+
+#endif // DISPATCH_H
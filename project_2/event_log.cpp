@@ -0,0 +1,223 @@
+#include "event_log.h"
+#include "simulation.h"
+
+using namespace std;
+
+// --- Formatting ---
+
+void formatLogRecord(string& out, const LogRecord& r, int ta_count) {
+    out += "[T=";
+    out += to_string(r.time);
+    out += "] ";
+    switch (r.kind) {
+        case LOG_SEAT:
+            out += "Student S" + to_string(r.student) + " arrives and takes a seat.\n";
+            break;
+        case LOG_STUDENT_WAKES:
+            out += "Student S" + to_string(r.student) + " wakes up " + taName(r.ta, ta_count) + ".\n";
+            break;
+        case LOG_RETRY:
+            out += "Student S" + to_string(r.student) + " arrives but hall is full, will retry at "
+                 + to_string(r.value) + " min.\n";
+            break;
+        case LOG_LEAVE:
+            out += "Student S" + to_string(r.student)
+                 + " arrives but hall is full but time is not enough.( Just Leave )\n";
+            break;
+        case LOG_TA_SLEEP:
+            out += taName(r.ta, ta_count) + " is sleeping.\n";
+            break;
+        case LOG_TA_WAKE:
+            out += taName(r.ta, ta_count) + " wakes up.\n";
+            break;
+        case LOG_TA_START:
+            out += taName(r.ta, ta_count) + " starts helping S" + to_string(r.student) + "\n";
+            break;
+        case LOG_FINISH:
+            out += "Student S" + to_string(r.student) + " finished and leaves.\n";
+            break;
+        case LOG_REQUEUE:
+            out += taName(r.ta, ta_count) + " sends S" + to_string(r.student) + " back to the hallway, "
+                 + to_string(r.value) + " min still needed.\n";
+            break;
+    }
+}
+
+void formatDetail(string& out, const DetailSnapshot& d) {
+    int ta_count = d.ta_state.size();
+    out += "=============================\n";
+    out += "Time: ";
+    for (int k = 0; k < ta_count; ++k) {
+        out += taName(k, ta_count) + " state: ";
+        if (d.ta_state[k] == 0)      out += "0 (sleeping)\n";
+        else if (d.office[k] != -1)  out += "1 (helping)\n";
+        else                         out += "1 (available)\n";
+    }
+
+    out += "Current Office Chair: ";
+    for (int sid : d.office) {
+        if (sid == -1) out += "[ ]";
+        else           out += "[S" + to_string(sid) + "]";
+    }
+    out += '\n';
+
+    out += "Current Hallway Chairs: ";
+    for (int sid : d.hall) out += "[S" + to_string(sid) + "]";
+    for (int i = d.hall.size(); i < d.chairs; ++i) out += "[  ]";
+    out += '\n';
+}
+
+// --- EventLog::Ring ---
+
+EventLog::Ring::Ring() {
+    write_block = read_block = new Block;
+}
+
+EventLog::Ring::~Ring() {
+    while (read_block) {
+        Block* next = read_block->next.load(memory_order_acquire);
+        delete read_block;
+        read_block = next;
+    }
+}
+
+void EventLog::Ring::push(const LogRecord& record) {
+    if (write_pos == BLOCK_RECORDS) {
+        // Never wait for the writer, chain a fresh block instead
+        Block* block = new Block;
+        write_block->next.store(block, memory_order_release);
+        write_block = block;
+        write_pos = 0;
+    }
+    write_block->records[write_pos] = record;
+    write_block->count.store(++write_pos, memory_order_release);
+}
+
+void EventLog::Ring::push(int time, LogKind kind, int student, int ta, int value) {
+    LogRecord record;
+    record.time     = time;
+    record.student  = student;
+    record.value    = value;
+    record.ta       = ta;
+    record.kind     = kind;
+    record.reserved = 0;
+    push(record);
+}
+
+const LogRecord* EventLog::Ring::front() {
+    for (;;) {
+        if (read_pos < read_block->count.load(memory_order_acquire)) {
+            return &read_block->records[read_pos];
+        }
+        if (read_pos < BLOCK_RECORDS) return nullptr;
+        // Block used up, move on once the producer linked the next one
+        Block* next = read_block->next.load(memory_order_acquire);
+        if (!next) return nullptr;
+        delete read_block;
+        read_block = next;
+        read_pos = 0;
+    }
+}
+
+void EventLog::Ring::pop() {
+    ++read_pos;
+}
+
+// --- EventLog ---
+
+EventLog::EventLog(int ring_count, int ta_count_, ostream* out_)
+    : ta_count(ta_count_), out(out_) {
+    for (int i = 0; i < ring_count; ++i) rings.emplace_back(new Ring);
+}
+
+EventLog::~EventLog() {
+    close();
+}
+
+bool EventLog::openTrace(const string& path) {
+    trace = fopen(path.c_str(), "wb");
+    if (!trace) return false;
+    int32_t header[2] = { ta_count, (int32_t)sizeof(LogRecord) };
+    fwrite("TATRACE1", 1, 8, trace);
+    fwrite(header, sizeof(header), 1, trace);
+    return true;
+}
+
+void EventLog::start() {
+    writer = thread(&EventLog::writerLoop, this);
+}
+
+void EventLog::pushDetail(DetailSnapshot detail) {
+    lock_guard<mutex> lock(detail_mutex);
+    details.push_back(move(detail));
+}
+
+void EventLog::publish(int tick) {
+    // Sequentially consistent with idle: either the writer sees the new
+    // watermark before it sleeps or this sees it idle and wakes it
+    watermark.store(tick);
+    if (idle.load()) {
+        lock_guard<mutex> lock(wake_mutex);
+        wake_cond.notify_one();
+    }
+}
+
+void EventLog::close() {
+    if (!writer.joinable()) return;
+    closing.store(true);
+    {
+        lock_guard<mutex> lock(wake_mutex);
+        wake_cond.notify_one();
+    }
+    writer.join();
+    if (trace) {
+        fclose(trace);
+        trace = nullptr;
+    }
+}
+
+void EventLog::writerLoop() {
+    string batch;
+    vector<LogRecord> traced;
+    int next_tick = 1;
+    for (;;) {
+        bool last_pass = closing.load(memory_order_acquire);
+        int ready = watermark.load(memory_order_acquire);
+        if (next_tick > ready) {
+            if (last_pass) break;
+            // Caught up, sleep until the next publish() or close()
+            unique_lock<mutex> lock(wake_mutex);
+            idle.store(true);
+            wake_cond.wait(lock, [&] { return watermark.load() >= next_tick || closing.load(); });
+            idle.store(false);
+            continue;
+        }
+
+        for (; next_tick <= ready; ++next_tick) {
+            for (auto& r : rings) {
+                const LogRecord* record;
+                while ((record = r->front()) && record->time <= next_tick) {
+                    ++records;
+                    if (out) formatLogRecord(batch, *record, ta_count);
+                    if (trace) traced.push_back(*record);
+                    r->pop();
+                }
+            }
+            lock_guard<mutex> lock(detail_mutex);
+            while (!details.empty() && details.front().time <= next_tick) {
+                if (out) formatDetail(batch, details.front());
+                details.pop_front();
+            }
+        }
+
+        if (out) {
+            out->write(batch.data(), batch.size());
+            out->flush();
+            batch.clear();
+        }
+        if (trace) {
+            fwrite(traced.data(), sizeof(LogRecord), traced.size(), trace);
+            traced.clear();
+        }
+    }
+}
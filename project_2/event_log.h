@@ -0,0 +1,142 @@
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "cache_aligned.h"
+
+// Kinds of [T=...] log lines
+enum LogKind : uint8_t {
+    LOG_SEAT = 0,       // student arrives and takes a seat
+    LOG_STUDENT_WAKES,  // student wakes up a TA
+    LOG_RETRY,          // hall is full, value = retry time
+    LOG_LEAVE,          // hall is full and no time is left
+    LOG_TA_SLEEP,
+    LOG_TA_WAKE,
+    LOG_TA_START,       // TA starts helping the student
+    LOG_FINISH,         // student finished and leaves
+    LOG_REQUEUE         // session cut short, value = minutes still needed
+};
+
+// One log line in compact binary form, also the record of the trace file
+struct LogRecord {
+    int32_t time;
+    int32_t student;    // -1 if none
+    int32_t value;      // kind specific
+    int16_t ta;         // -1 if none
+    uint8_t kind;
+    uint8_t reserved;
+};
+
+// State of the office at the end of one tick, for the detailed printout
+struct DetailSnapshot {
+    int time = 0;
+    int chairs = 0;
+    std::vector<int> ta_state;  // TA statement, 0 sleeping / 1 awake
+    std::vector<int> office;    // student in each office, -1 if none
+    std::vector<int> hall;      // seated students, front first
+};
+
+// Shared by both engines so their logs are identical
+void formatLogRecord(std::string& out, const LogRecord& record, int ta_count);
+void formatDetail(std::string& out, const DetailSnapshot& detail);
+
+// Asynchronous log of the threaded simulation.
+//
+// Every simulation thread appends LogRecords to its own ring, which never
+// blocks: it is a single-producer/single-consumer chain of fixed blocks and
+// the producer links a new block when the current one is full. A background
+// writer drains the rings tick by tick once the controller has published the
+// tick, orders each tick by ring index (student workers first, then the TA
+// threads, then the detail snapshot) and writes the formatted lines in one
+// batch. Optionally the same records are appended to a binary trace file:
+// an 8 byte "TATRACE1" magic, int32 TA count, int32 record size, then the
+// LogRecords in log order.
+class EventLog {
+    public:
+        class Ring : public CacheAligned {
+            private:
+                static const int BLOCK_RECORDS = 1024;
+                struct Block : CacheAligned {
+                    LogRecord records[BLOCK_RECORDS];
+                    alignas(64) std::atomic<int> count{0};
+                    std::atomic<Block*> next{nullptr};
+                };
+
+                // Producer side
+                Block* write_block;
+                int write_pos = 0;
+                // Consumer side
+                alignas(64) Block* read_block;
+                int read_pos = 0;
+
+            public:
+                Ring();
+                ~Ring();
+                Ring(const Ring&) = delete;
+                Ring& operator=(const Ring&) = delete;
+
+                // --- Producer side ---
+                void push(const LogRecord& record);
+                void push(int time, LogKind kind, int student, int ta = -1, int value = 0);
+
+                // --- Consumer side ---
+                // Oldest record not consumed yet, nullptr if none is published
+                const LogRecord* front();
+                void pop();
+        };
+
+    private:
+        std::vector<std::unique_ptr<Ring> > rings;
+        int ta_count;
+        std::ostream* out;          // nullptr: drain without formatting
+        FILE* trace = nullptr;
+        unsigned long long records = 0;
+
+        std::mutex detail_mutex;    // only the controller and the writer take it
+        std::deque<DetailSnapshot> details;
+
+        std::atomic<int> watermark{0};  // every record up to this tick is pushed
+        std::atomic<bool> closing{false};
+        // The writer sleeps on wake_cond once it has caught up. It raises
+        // idle first, so publish() only takes the mutex to wake it then.
+        std::atomic<bool> idle{false};
+        std::mutex wake_mutex;
+        std::condition_variable wake_cond;
+        std::thread writer;
+
+        void writerLoop();
+
+    public:
+        // ring_count rings, one per producing thread, written to out (may be nullptr)
+        EventLog(int ring_count, int ta_count_, std::ostream* out_);
+        ~EventLog();
+        EventLog(const EventLog&) = delete;
+        EventLog& operator=(const EventLog&) = delete;
+
+        // Also write the records to a binary trace file. Call before start().
+        bool openTrace(const std::string& path);
+        void start();
+
+        Ring& ring(int i) { return *rings[i]; }
+
+        // --- Controller side ---
+        void pushDetail(DetailSnapshot detail);
+        // All records up to tick are pushed, the writer may print them
+        void publish(int tick);
+        // Write everything left and stop the writer
+        void close();
+        // Records drained so far, exact after close()
+        unsigned long long recordCount() const { return records; }
+};
+
+#endif // EVENT_LOG_H
@@ -0,0 +1,252 @@
+#include "event_sim.h"
+
+using namespace std;
+
+// --- Event ordering ---
+bool Event::operator>(const Event& other) const {
+    if (time != other.time) return time > other.time;
+    if (ta != other.ta)     return ta > other.ta;
+    if (type != other.type) return type > other.type;
+    return student > other.student;
+}
+
+// --- EventSimulator ---
+
+EventSimulator::EventSimulator(vector<Student>& students_, int chairs_, int total_minutes_, int ta_count,
+                               Xoshiro256& engine_, ostream* log_, bool print_detail_,
+                               RunStats* stats_, const DispatchSpec& policy)
+    : students(&students_), chairs(chairs_), total_minutes(total_minutes_), retry_seed(engine_()),
+      log(log_), print_detail(print_detail_ && log_ != nullptr), stats(stats_),
+      hall(makeDispatchPolicy(policy, chairs_, students_.size())), tas(ta_count) {}
+
+EventSimulator::EventSimulator(ArrivalTrace& trace_, int chairs_, int total_minutes_, int ta_count,
+                               Xoshiro256& engine_, ostream* log_, bool print_detail_,
+                               RunStats* stats_, const DispatchSpec& policy)
+    : students(nullptr), trace(&trace_), chairs(chairs_), total_minutes(total_minutes_), retry_seed(engine_()),
+      log(log_), print_detail(print_detail_ && log_ != nullptr), stats(stats_),
+      hall(makeDispatchPolicy(policy, chairs_, trace_.maxRows())), tas(ta_count) {}
+
+// Queue an event, events after the end of the simulation never happen
+void EventSimulator::schedule(int time, EventType type, int ta, int student) {
+    if (time < 1 || time > total_minutes) return;
+    events.push(Event{time, type, ta, student});
+}
+
+// Read the next trace row and queue its arrival. Rows are sorted, so the
+// first one past the end of the simulation ends the trace.
+void EventSimulator::scheduleNextTraceArrival() {
+    pending_arrival = -1;
+    int arrival, question_time;
+    if (!trace->next(arrival, question_time) || arrival > total_minutes) return;
+    if (arrival < 1) arrival = 1;
+
+    int sid = trace_students++;
+    Student& stu = active.emplace(sid, Student(sid, 1, question_time, arrival)).first->second;
+    stu.attachStats(stats);
+    pending_arrival = sid;
+    schedule(arrival, EVENT_ARRIVAL, -1, sid);
+}
+
+Student& EventSimulator::student(int sid) {
+    return students ? (*students)[sid] : active.find(sid)->second;
+}
+
+// A trace student is done with the office and will not be looked at again
+void EventSimulator::retire(int sid) {
+    if (!students) active.erase(sid);
+}
+
+void EventSimulator::run() {
+    if (students) {
+        for (const auto& s : *students) {
+            schedule(s.getArrivalTime(), EVENT_ARRIVAL, -1, s.getId());
+        }
+    } else {
+        scheduleNextTraceArrival();
+    }
+    // Every TA looks at their office on the first tick
+    for (int k = 0; k < (int)tas.size(); ++k) {
+        schedule(1, EVENT_TA_IDLE, k);
+    }
+
+    int printed = 0;    // last minute whose state has been printed and sampled
+    while (!events.empty()) {
+        Event e = events.top();
+        events.pop();
+        ++event_count;
+
+        // Every minute before this event is complete and nothing changed in it
+        if (printed < e.time - 1) {
+            sample(printed + 1, e.time - 1);
+            if (print_detail) {
+                for (int t = printed + 1; t < e.time; ++t) printDetail(t);
+            }
+            printed = e.time - 1;
+        }
+
+        switch (e.type) {
+            case EVENT_ARRIVAL:     arrive(e.time, e.student); break;
+            case EVENT_HELP_FINISH: finishHelp(e.time, e.ta);  break;
+            case EVENT_TA_IDLE:     idle(e.time, e.ta);        break;
+            case EVENT_TA_WAKE:     wake(e.time, e.ta);        break;
+            case EVENT_HELP_START:  startHelp(e.time, e.ta);   break;
+        }
+    }
+    if (printed < total_minutes) {
+        sample(printed + 1, total_minutes);
+        if (print_detail) {
+            for (int t = printed + 1; t <= total_minutes; ++t) printDetail(t);
+        }
+    }
+
+    // The end of the simulation wakes sleeping TAs and interrupts help sessions
+    for (auto& t : tas) {
+        if (t.ta.getStatement() == 0) t.stats.nap_time += total_minutes - t.nap_start_time;
+        if (t.office != -1)           t.stats.busy_time += total_minutes - t.help_start_time;
+    }
+}
+
+// Student sid comes to the hallway
+void EventSimulator::arrive(int now, int sid) {
+    // The next trace row arrives at this minute or later
+    if (trace && sid == pending_arrival) scheduleNextTraceArrival();
+    Student& stu = student(sid);
+
+    if (hall->tryPush(sid, stu.getQuestionTime())) {  // Student takes a seat in the hallway
+        stu.setStatement(2);
+        logEvent(now, LOG_SEAT, sid);
+
+        // Wake the first sleeping TA nobody is waking yet
+        for (int k = 0; k < (int)tas.size(); ++k) {
+            if (tas[k].ta.getStatement() == 0 && !tas[k].wake_pending) {
+                logEvent(now, LOG_STUDENT_WAKES, sid, k);
+                tas[k].wake_pending = true;
+                schedule(now, EVENT_TA_WAKE, k);
+                break;
+            }
+        }
+        return;
+    }
+
+    // No seats available in the hallway, student will try again later
+    int new_time = retryTime(retry_seed, sid, now, total_minutes);
+    stu.setArrivalTime(new_time);
+    if (new_time <= total_minutes) {
+        logEvent(now, LOG_RETRY, sid, -1, new_time);
+        schedule(new_time, EVENT_ARRIVAL, -1, sid);
+    } else {
+        stu.setStatement(3);
+        logEvent(now, LOG_LEAVE, sid);
+        retire(sid);
+    }
+}
+
+// The help session in the TA's office is over
+void EventSimulator::finishHelp(int now, int ta) {
+    int sid = tas[ta].office;
+    tas[ta].office = -1;
+    tas[ta].stats.busy_time += now - tas[ta].help_start_time;
+    if (tas[ta].remaining > 0) {
+        // Cut short by the policy, the student waits for the rest
+        hall->requeue(sid, tas[ta].remaining);
+        logEvent(now, LOG_REQUEUE, sid, ta, tas[ta].remaining);
+    } else {
+        tas[ta].stats.helped++;
+        Student& stu = student(sid);
+        stu.setHelped(true);
+        stu.setTurnaroundTime(now - stu.getArrivalTime());
+        logEvent(now, LOG_FINISH, sid, ta);
+        retire(sid);
+    }
+
+    if (hall->size() > 0) {
+        schedule(now, EVENT_HELP_START, ta);
+    } else {
+        // The TA finds the office empty on the next tick
+        schedule(now + 1, EVENT_TA_IDLE, ta);
+    }
+}
+
+// The TA is awake with nobody in the office
+void EventSimulator::idle(int now, int ta) {
+    if (hall->size() > 0) {
+        schedule(now, EVENT_HELP_START, ta);
+        return;
+    }
+    tas[ta].ta.setStatement(0);
+    tas[ta].nap_start_time = now;
+    logEvent(now, LOG_TA_SLEEP, -1, ta);
+}
+
+// A student woke the TA up
+void EventSimulator::wake(int now, int ta) {
+    TAState& t = tas[ta];
+    t.stats.nap_time += now - t.nap_start_time;
+    t.ta.setStatement(1);
+    t.wake_pending = false;
+    logEvent(now, LOG_TA_WAKE, -1, ta);
+    schedule(now, EVENT_HELP_START, ta);
+}
+
+// Move the next waiting student into the TA's office
+void EventSimulator::startHelp(int now, int ta) {
+    // Another TA may have taken the student already
+    int sid, remaining;
+    if (!hall->tryPop(sid, remaining)) {
+        schedule(now + 1, EVENT_TA_IDLE, ta);
+        return;
+    }
+    int session = hall->slice(remaining);
+    tas[ta].office = sid;
+    tas[ta].remaining = remaining - session;
+    tas[ta].help_start_time = now;
+    Student& stu = student(sid);
+    // Waiting ends with the first session
+    if (remaining == stu.getQuestionTime()) stu.setWaitTime(now - stu.getArrivalTime());
+    logEvent(now, LOG_TA_START, sid, ta);
+    schedule(now + session, EVENT_HELP_FINISH, ta);
+}
+
+// Same formatting as the log of the threaded simulation
+void EventSimulator::logEvent(int now, LogKind kind, int student, int ta, int value) const {
+    if (!log) return;
+    LogRecord record{now, student, value, (int16_t)ta, kind, 0};
+    string line;
+    formatLogRecord(line, record, tas.size());
+    *log << line;
+}
+
+void EventSimulator::printDetail(int now) const {
+    DetailSnapshot detail;
+    detail.time   = now;
+    detail.chairs = chairs;
+    for (const auto& t : tas) {
+        detail.ta_state.push_back(t.ta.getStatement());
+        detail.office.push_back(t.office);
+    }
+    detail.hall = hall->snapshot();
+
+    string text;
+    formatDetail(text, detail);
+    *log << text;
+}
+
+// The office stays as it is for the minutes [first, last]
+void EventSimulator::sample(int first, int last) const {
+    if (!stats) return;
+    int busy = 0;
+    for (const auto& t : tas) busy += t.office != -1;
+    stats->series.record(first, last, hall->size(), busy);
+}
+
+int EventSimulator::getNapTime() const {
+    int total = 0;
+    for (const auto& t : tas) total += t.stats.nap_time;
+    return total;
+}
+
+vector<TAStats> EventSimulator::getTAStats() const {
+    vector<TAStats> stats;
+    for (const auto& t : tas) stats.push_back(t.stats);
+    return stats;
+}
@@ -0,0 +1,122 @@
+#ifndef EVENT_SIM_H
+#define EVENT_SIM_H
+
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "helper.h"
+#include "simulation.h"
+#include "event_log.h"
+#include "stats.h"
+#include "arrival_trace.h"
+#include "dispatch.h"
+
+// Kinds of simulation events. Events at the same minute are processed like one
+// tick of the threaded simulation: all arrivals first, then each TA in turn,
+// and the events of one TA in this order.
+enum EventType {
+    EVENT_ARRIVAL = 0,
+    EVENT_HELP_FINISH,
+    EVENT_TA_IDLE,
+    EVENT_TA_WAKE,
+    EVENT_HELP_START
+};
+
+struct Event {
+    int time;
+    EventType type;
+    int ta;         // TA index, -1 for arrivals
+    int student;    // student id, -1 for TA events
+
+    // Min-heap order: time, then TA (arrivals first), then type, then student id
+    bool operator>(const Event& other) const;
+};
+
+// Discrete-event version of the sleeping-TA simulation.
+// Instead of waking every thread each simulated minute, it jumps from one
+// event to the next, so idle minutes cost nothing. It produces the same
+// [T=...] event log as the threaded simulation and fills in the wait time,
+// turnaround time and helped flag of every student.
+//
+// Any number of TAs serve the one hallway. An arriving student wakes the
+// lowest numbered sleeping TA nobody is waking yet, and TAs free at the same
+// minute take waiting students in TA order. The dispatch policy decides which
+// waiting student that is and how long one session lasts.
+//
+// Retry times are keyed on a seed taken from the engine passed in, so they
+// match the threaded simulation's when its seed's stream 1 is passed.
+//
+// Students come either from a vector filled in up front or from an
+// ArrivalTrace. A trace is read one row ahead of the clock and a student only
+// exists while they are in the building, so memory stays bounded by the
+// people present at once, not by the length of the trace.
+class EventSimulator {
+    private:
+        struct TAState {
+            TA ta{1};
+            int office          = -1;   // student being helped, -1 if none
+            int remaining       = 0;    // minutes they still need after this session
+            bool wake_pending   = false;
+            int help_start_time = -1;
+            int nap_start_time  = -1;
+            TAStats stats;
+        };
+
+        std::vector<Student>* students;     // nullptr: replaying a trace
+        ArrivalTrace* trace = nullptr;
+        std::unordered_map<int, Student> active;    // trace students still around
+        int trace_students = 0;     // rows read so far, the next id
+        int pending_arrival = -1;   // trace student whose arrival is queued
+        int chairs;
+        int total_minutes;
+        uint64_t retry_seed;    // key of the retry times, see retryTime
+        std::ostream* log;      // nullptr: run headless
+        bool print_detail;
+        RunStats* stats;        // nullptr: no time series
+
+        std::priority_queue<Event, std::vector<Event>, std::greater<Event> > events;
+        std::unique_ptr<DispatchPolicy> hall;
+        std::vector<TAState> tas;
+        long long event_count = 0;
+
+        void schedule(int time, EventType type, int ta, int student = -1);
+        void scheduleNextTraceArrival();
+        Student& student(int sid);
+        void retire(int sid);
+
+        void arrive(int now, int sid);
+        void finishHelp(int now, int ta);
+        void idle(int now, int ta);
+        void wake(int now, int ta);
+        void startHelp(int now, int ta);
+
+        void logEvent(int now, LogKind kind, int student, int ta = -1, int value = 0) const;
+        void printDetail(int now) const;
+        void sample(int first, int last) const;
+
+    public:
+        EventSimulator(std::vector<Student>& students_, int chairs_, int total_minutes_, int ta_count,
+                       Xoshiro256& engine_, std::ostream* log_, bool print_detail_,
+                       RunStats* stats_ = nullptr, const DispatchSpec& policy = DispatchSpec());
+        // Replay the arrivals of a trace, students get stats_ attached
+        EventSimulator(ArrivalTrace& trace_, int chairs_, int total_minutes_, int ta_count,
+                       Xoshiro256& engine_, std::ostream* log_, bool print_detail_,
+                       RunStats* stats_ = nullptr, const DispatchSpec& policy = DispatchSpec());
+
+        // Run the whole simulation
+        void run();
+
+        // Total nap time of all TAs
+        int getNapTime() const;
+        std::vector<TAStats> getTAStats() const;
+        // Events processed by run()
+        long long getEventCount() const { return event_count; }
+        // Students simulated, trace rows up to the end of the simulation
+        int getStudentCount() const { return students ? (int)students->size() : trace_students; }
+};
+
+#endif // EVENT_SIM_H
@@ -0,0 +1,79 @@
+#include "hallway_ring.h"
+
+using namespace std;
+
+// --- HallwayRing ---
+
+HallwayRing::HallwayRing(int capacity_)
+    : cells(capacity_ > 2 ? capacity_ : 2), slots(cells.size()), capacity(capacity_ > 0 ? capacity_ : 0) {
+    for (size_t i = 0; i < cells.size(); ++i) {
+        cells[i].sequence.store(i, memory_order_relaxed);
+    }
+}
+
+bool HallwayRing::tryPush(int student, int remaining) {
+    if (capacity == 0) return false;    // no chairs at all
+    unsigned long pos = tail.load(memory_order_relaxed);
+    for (;;) {
+        Cell& cell = cells[pos % slots];
+        unsigned long seq = cell.sequence.load(memory_order_acquire);
+        long diff = (long)(seq - pos);
+        if (diff == 0) {
+            // Every chair taken? head only grows, so a stale value can refuse
+            // a student a chair just being freed but never seat one too many
+            if (pos - head.load(memory_order_acquire) >= (unsigned long)capacity) return false;
+            // The cell is free for this position, try to claim it
+            if (tail.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                cell.student   = student;
+                cell.remaining = remaining;
+                cell.sequence.store(pos + 1, memory_order_release);
+                return true;
+            }
+            retries.fetch_add(1, memory_order_relaxed);
+        } else if (diff < 0) {
+            return false;   // the cell still holds the value from one lap ago
+        } else {
+            pos = tail.load(memory_order_relaxed);  // another student got here first
+        }
+    }
+}
+
+bool HallwayRing::tryPop(int& student, int& remaining) {
+    if (capacity == 0) return false;
+    unsigned long pos = head.load(memory_order_relaxed);
+    for (;;) {
+        Cell& cell = cells[pos % slots];
+        unsigned long seq = cell.sequence.load(memory_order_acquire);
+        long diff = (long)(seq - (pos + 1));
+        if (diff == 0) {
+            if (head.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                student   = cell.student;
+                remaining = cell.remaining;
+                // Free the cell for the push one lap later
+                cell.sequence.store(pos + slots, memory_order_release);
+                return true;
+            }
+            retries.fetch_add(1, memory_order_relaxed);
+        } else if (diff < 0) {
+            return false;   // nothing pushed at this position yet
+        } else {
+            pos = head.load(memory_order_relaxed);  // another TA got here first
+        }
+    }
+}
+
+int HallwayRing::size() const {
+    unsigned long h = head.load(memory_order_acquire);
+    unsigned long t = tail.load(memory_order_acquire);
+    return t > h ? (int)(t - h) : 0;
+}
+
+vector<int> HallwayRing::snapshot() const {
+    vector<int> seated;
+    unsigned long h = head.load(memory_order_acquire);
+    unsigned long t = tail.load(memory_order_acquire);
+    for (unsigned long pos = h; pos < t; ++pos) {
+        seated.push_back(cells[pos % slots].student);
+    }
+    return seated;
+}
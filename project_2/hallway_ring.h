@@ -0,0 +1,56 @@
+#ifndef HALLWAY_RING_H
+#define HALLWAY_RING_H
+
+#include <atomic>
+#include <vector>
+
+// Fixed-capacity lock-free FIFO of student ids for the hallway chairs, each
+// with the minutes of help the student still needs.
+//
+// Bounded multi-producer/multi-consumer ring after Dmitry Vyukov: every cell
+// carries a sequence number telling whether it is free for the push at
+// position pos (sequence == pos) or holds the value for the pop at position
+// pos (sequence == pos + 1). Students claim a position with a CAS on tail and
+// TAs with a CAS on head, so nobody ever blocks, a failed tryPush means every
+// chair is taken, and ids leave in exactly the order their pushes claimed
+// positions.
+//
+// The scheme needs at least two cells: with one, a freed cell's sequence
+// (pos + 1) would read as full. So there are never fewer than two cells and
+// the number of chairs is enforced apart from them, against head.
+class HallwayRing {
+    private:
+        struct Cell {
+            std::atomic<unsigned long> sequence;
+            int student;
+            int remaining;
+        };
+
+        std::vector<Cell> cells;
+        unsigned long slots;    // cells.size(), at least 2
+        int capacity;           // chairs
+        // Students and TAs update different ends, keep them on separate lines
+        alignas(64) std::atomic<unsigned long> tail{0};    // next push position
+        alignas(64) std::atomic<unsigned long> head{0};    // next pop position
+        alignas(64) std::atomic<unsigned long> retries{0}; // lost CAS races, for benchmarks
+
+    public:
+        explicit HallwayRing(int capacity_);
+        HallwayRing(const HallwayRing&) = delete;
+        HallwayRing& operator=(const HallwayRing&) = delete;
+
+        // Take a chair. Returns false if the hall is full.
+        bool tryPush(int student, int remaining);
+        // Take the student who has waited longest. Returns false if the hall is empty.
+        bool tryPop(int& student, int& remaining);
+
+        // Students currently seated. Only exact while nobody pushes or pops.
+        int size() const;
+        // Seated students from the front of the hall to the back. Only call
+        // while nobody pushes or pops, e.g. between ticks.
+        std::vector<int> snapshot() const;
+
+        unsigned long casRetries() const { return retries.load(std::memory_order_relaxed); }
+};
+
+#endif // HALLWAY_RING_H
@@ -1,16 +1,114 @@
 #include "helper.h"
+#include "stats.h"
 #include <fstream>
 #include <sstream>
 #include <random>
 
 
 
+static uint64_t master_seed = std::random_device{}();
+
+// --- Xoshiro256 ---
+
+// SplitMix64 spreads one seed over the whole state
+Xoshiro256::Xoshiro256(uint64_t seed) {
+    for (auto& word : s) {
+        uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        word = z ^ (z >> 31);
+    }
+}
+
+static inline uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+Xoshiro256::result_type Xoshiro256::operator()() {
+    uint64_t result = rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+void Xoshiro256::jump() {
+    static const uint64_t JUMP[] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                                     0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+    uint64_t t[4] = { 0, 0, 0, 0 };
+    for (uint64_t word : JUMP) {
+        for (int b = 0; b < 64; ++b) {
+            if (word & (1ULL << b)) {
+                for (int i = 0; i < 4; ++i) t[i] ^= s[i];
+            }
+            (*this)();
+        }
+    }
+    for (int i = 0; i < 4; ++i) s[i] = t[i];
+}
+
+double Xoshiro256::nextDouble() {
+    return ((*this)() >> 11) * (1.0 / 9007199254740992.0);  // 53 random bits
+}
+
+// --- Function: randomStream ---
+Xoshiro256 randomStream(uint64_t seed, int stream) {
+    Xoshiro256 engine(seed);
+    for (int k = 0; k < stream; ++k) engine.jump();
+    return engine;
+}
+
+Xoshiro256 randomStream(int stream) {
+    return randomStream(master_seed, stream);
+}
+
+// --- Function: keyedStream ---
+// The SplitMix64 finaliser hashes the key into a seed of its own
+static uint64_t mix64(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+Xoshiro256 keyedStream(uint64_t seed, uint64_t a, uint64_t b) {
+    return Xoshiro256(mix64(seed ^ mix64(a ^ mix64(b + 0x9e3779b97f4a7c15ULL))));
+}
+
+// --- Function: seedRandomTime ---
+// Makes the streams, and so the random times, reproducible.
+void seedRandomTime(uint64_t seed) {
+    master_seed = seed;
+}
+
+uint64_t masterSeed() {
+    return master_seed;
+}
+
 // --- Function: getRandomTime ---
 // Returns a random integer between low and high (inclusive).
+// Lemire's multiply-shift maps a 64 bit draw onto the range, redrawing only
+// the rare values that would make some results more likely.
+int getRandomTime(Xoshiro256& engine, int low, int high) {
+    uint64_t range = (uint64_t)((int64_t)high - low) + 1;
+    unsigned __int128 m = (unsigned __int128)engine() * range;
+    uint64_t l = (uint64_t)m;
+    if (l < range) {
+        uint64_t threshold = -range % range;
+        while (l < threshold) {
+            m = (unsigned __int128)engine() * range;
+            l = (uint64_t)m;
+        }
+    }
+    return (int)(low + (int64_t)(m >> 64));
+}
+
 int getRandomTime(int low, int high) {
-    static std::default_random_engine gen(std::random_device{}());  // Random engine
-    std::uniform_int_distribution<int> dist(low, high);             // Uniform distribution
-    return dist(gen);  // Generate and return random number
+    static thread_local Xoshiro256 engine(std::random_device{}());
+    return getRandomTime(engine, low, high);
 }
 
 
@@ -20,7 +118,7 @@ int getRandomTime(int low, int high) {
 TA::TA(int initialState) : Statement(initialState) {}
 
 // Get TA's current state (0 = sleeping, 1 = working/available)
-int TA::getStatement() {
+int TA::getStatement() const {
     return Statement;
 }
 
@@ -40,7 +138,7 @@ void Student::Change_Arrival_Time(int now_time, int end_time) {
     arrival_time = getRandomTime(now_time, end_time);
 }
 // ==== Statement ====
-// Get the current state of the student (1 = coding, 2 = waiting for help)
+// Get the current state of the student (1 = coding, 2 = waiting for help, 3 = left)
 int Student::getStatement() const {
     return Statement;
 }
@@ -48,6 +146,10 @@ int Student::getStatement() const {
 void Student::setStatement(int s) {
     Statement = s;
 }
+
+void Student::attachStats(RunStats* s) {
+    stats = s;
+}
 // ==== ID ====
 // Get student ID
 int Student::getId() const {
@@ -83,6 +185,7 @@ int Student::getWaitTime() const {
 // Set total time from arrival to leaving (turnaround time)
 void Student::setTurnaroundTime(int t) {
     turnaround_time = t;
+    if (stats) stats->turnaround.record(t);
 }
 // Get the student's turnaround time
 int Student::getTurnaroundTime() const {
@@ -94,6 +197,11 @@ int Student::getTurnaroundTime() const {
 // Set whether student received help or not
 void Student::setHelped(bool h) {
     helped = h;
+    // Like the question time, the wait only counts once the student is helped
+    if (stats && h) {
+        stats->wait.record(wait_time);
+        stats->question.record(question_time);
+    }
 }
 
 // Check if student was helped
@@ -4,7 +4,45 @@
 #include <string>
 #include <vector>
 #include <iostream>
+#include <cstdint>
+#include <random>
 
+struct RunStats;
+
+// xoshiro256** generator (Blackman & Vigna). Small, fast and lock-free since
+// every thread owns its own. jump() advances by 2^128 draws, so streams
+// made by jumping a common seed never overlap.
+class Xoshiro256 {
+    private:
+        uint64_t s[4];
+
+    public:
+        typedef uint64_t result_type;
+
+        explicit Xoshiro256(uint64_t seed = 0);
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return UINT64_MAX; }
+        result_type operator()();
+
+        void jump();
+        // Uniform double in [0, 1)
+        double nextDouble();
+};
+
+// Stream k of the seed: the seed's generator jumped k times
+Xoshiro256 randomStream(uint64_t seed, int stream);
+// Same for the master seed (random unless seedRandomTime was called)
+Xoshiro256 randomStream(int stream);
+// Generator for the draws belonging to (a, b), e.g. a student at a tick:
+// the same no matter which thread makes them or when
+Xoshiro256 keyedStream(uint64_t seed, uint64_t a, uint64_t b);
+void seedRandomTime(uint64_t seed);
+uint64_t masterSeed();
+
+// Random integer in [min, max] from the engine, without bias
+int getRandomTime(Xoshiro256& engine, int min, int max);
+// Same from a stream owned by the calling thread (not reproducible)
 int getRandomTime(int min, int max);
 
 
@@ -15,7 +53,7 @@ class TA {
         int Statement;
     public:
         TA(int initialState = 1);
-        int getStatement();
+        int getStatement() const;
         void setStatement(int s);
 };
 
@@ -24,6 +62,7 @@ class Student {
         int Statement;
         // 1: Codeing
         // 2: Seeking Help
+        // 3: Left without help
         int id;
         int question_time;
         int arrival_time;
@@ -31,6 +70,7 @@ class Student {
         int wait_time = 0;
         int turnaround_time = 0;
         bool helped = false;
+        RunStats* stats = nullptr;  // receives the times as they are set
 
     public:
         Student(int id_, int statement_, int q_time, int a_time);
@@ -44,6 +84,9 @@ class Student {
 
         void setStatement(int s);
 
+        // Record wait, turnaround and question times in stats from now on
+        void attachStats(RunStats* s);
+
         // static setter/getter
         void setWaitTime(int w);
         int getWaitTime() const;
@@ -1,265 +1,122 @@
-#include <pthread.h>
-#include <semaphore.h>
-#include <unistd.h>
 #include <iostream>
 #include <vector>
-#include <queue>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <thread>
 #include "helper.h"   // TA, Student, and helper functions
+#include "event_sim.h"
+#include "simulation.h"
+#include "batch.h"
+#include "stats.h"
+#include "thread_sim.h"
+#include "replication.h"
+#include "arrival_trace.h"
+#include <fstream>
+#include <iomanip>
 
 using namespace std;
 
-/* ========= Global State ========= */
-int Total_minutes = 0;
-int current_time  = 0;
-bool simulation_running = true;
-
-/* ========= Synchronization Primitives ========= */
-pthread_mutex_t time_mutex  = PTHREAD_MUTEX_INITIALIZER;
-pthread_cond_t  tick_cond   = PTHREAD_COND_INITIALIZER;
-pthread_mutex_t queue_mutex = PTHREAD_MUTEX_INITIALIZER;
-pthread_mutex_t cout_mutex  = PTHREAD_MUTEX_INITIALIZER;
-sem_t ta_sleeping;
-
-/* ========= Data Structures ========= */
-TA TA_object(1);
-vector<Student> students_vector;
-
-int chairs = 0;
-queue<int> chairs_queue;
-queue<int> office_chair;
-
-int total_ta_nap_time = 0;
-int nap_start_time    = -1;
-int help_start_time   = -1;
-
-/* ========= Printting Detail ========= */
-void print＿time_detail() {
-    pthread_mutex_lock(&queue_mutex);
-    queue<int> hall = chairs_queue;
-    queue<int> off  = office_chair;
-    int ta_state = TA_object.getStatement();
-    pthread_mutex_unlock(&queue_mutex);
-
-    pthread_mutex_lock(&cout_mutex);
-    cout << "=============================\n";
-    cout << "Time: ";
-    cout << "TA state: ";
-    if (ta_state == 0)
-        cout << "0 (sleeping)\n";
-    else {
-        if (!off.empty()) cout << "1 (helping)\n";
-        else              cout << "1 (available)\n";
-    }
-
-    cout << "Current Office Chair: ";
-    if (off.empty()) cout << "[ ]\n";
-    else             cout << "[S" << off.front() << "]\n";
-
-    int filled = hall.size();
-    int empty  = chairs - filled;
-
-    cout << "Current Hallway Chairs: ";
-    while (!hall.empty()) {
-        cout << "[S" << hall.front() << "]";
-        hall.pop();
-    }
-    for (int i = 0; i < empty; ++i) cout << "[  ]";
-    cout << '\n';
-    pthread_mutex_unlock(&cout_mutex);
+// One line of the student list printed before the run
+static void print_student(int id, int arrival, int question) {
+    cout << "Student S" << id
+         << "  Arrival: "  << arrival << " min"
+         << "  Question: " << question << " min\n";
 }
 
-
-/* ========= TA Thread ========= */
-void* ta_function(void*){
-    while (true) {
-        // Lock the time mutex to safely access the simulation state and time
-        pthread_mutex_lock(&time_mutex);
-        if (!simulation_running) {
-            pthread_mutex_unlock(&time_mutex);
-            break;  // Exit the thread if simulation is no longer running
-        }
-        // Wait for a tick signal (time update) before proceeding
-        pthread_cond_wait(&tick_cond, &time_mutex);
-        int now = current_time;  // Store the current simulation time
-        pthread_mutex_unlock(&time_mutex);
-
-        // Lock the queue mutex to safely manage the student queues
-        pthread_mutex_lock(&queue_mutex);
-        if (TA_object.getStatement() == 1) {  // Check if TA is in active state
-            if (office_chair.empty()) {  // No student currently being helped
-                if (chairs_queue.empty()) {  // No students waiting in the hallway
-                    TA_object.setStatement(0);  // TA goes to sleep
-                    nap_start_time = now;  // Record when TA starts napping
-
-                    // Print message that TA is sleeping
-                    pthread_mutex_lock(&cout_mutex);
-                    cout << "[T=" << now << "] TA is sleeping.\n";
-                    pthread_mutex_unlock(&cout_mutex);
-                    pthread_mutex_unlock(&queue_mutex);
-                    sem_wait(&ta_sleeping);  // Block until a student wakes up the TA
-                    // Get the current simulation state and time after waking up
-                    pthread_mutex_lock(&time_mutex);
-                    bool running2 = simulation_running;
-                    int  wake_t   = current_time;
-                    pthread_mutex_unlock(&time_mutex);
-                    total_ta_nap_time += wake_t - nap_start_time;  // Track total nap time
-                    if (!running2) break;  // Exit if simulation ended while sleeping
-                    TA_object.setStatement(1);  // TA is now active
-                    pthread_mutex_lock(&queue_mutex);
-                    // Print message that TA woke up
-                    pthread_mutex_lock(&cout_mutex);
-                    cout << "[T=" << wake_t << "] TA wakes up.\n";
-                    pthread_mutex_unlock(&cout_mutex);
-                    if (!chairs_queue.empty()) {  // If students are waiting after TA wakes up
-                        int sid = chairs_queue.front();  // Get first waiting student
-                        chairs_queue.pop();
-                        office_chair.push(sid);  // Move student to the office
-                        int arrive = students_vector[sid].getArrivalTime();
-                        students_vector[sid].setWaitTime(wake_t - arrive);  // Calculate wait time
-                        help_start_time = wake_t;  // Record when help started
-                        // Print message that TA starts helping a student
-                        pthread_mutex_lock(&cout_mutex);
-                        cout << "[T=" << wake_t << "] TA starts helping S" << sid << '\n';
-                        pthread_mutex_unlock(&cout_mutex);
-                    }
-                    pthread_mutex_unlock(&queue_mutex);
-                    continue;  // Go back to the start of the loop
-                }
-
-                // At least one student is waiting in the hallway
-                int sid = chairs_queue.front();  // Get first waiting student
-                chairs_queue.pop();
-                office_chair.push(sid);  // Move student to the office
-                int arrive = students_vector[sid].getArrivalTime();
-                students_vector[sid].setWaitTime(now - arrive);  // Calculate wait time
-                help_start_time = now;  // Record when help started
-
-                // Print message that TA starts helping a student
-                pthread_mutex_lock(&cout_mutex);
-                cout << "[T=" << now << "] TA starts helping S" << sid << '\n';
-                pthread_mutex_unlock(&cout_mutex);
-            }
-            else {
-                // TA is currently helping a student, check if they are finished
-                int sid   = office_chair.front();
-                int qtime = students_vector[sid].getQuestionTime();
-
-                // Check if the help session is complete
-                if (help_start_time != -1 && now - help_start_time >= qtime) {
-                    office_chair.pop();  // Student leaves the office
-                    students_vector[sid].setHelped(true);  // Mark student as helped
-                    int arrive = students_vector[sid].getArrivalTime();
-                    students_vector[sid].setTurnaroundTime(now - arrive);  // Calculate total time in system
-                    help_start_time = -1;  // Reset help start time
-
-                    // Print message that student finished and leaves
-                    pthread_mutex_lock(&cout_mutex);
-                    cout << "[T=" << now << "] Student S" << sid << " finished and leaves.\n";
-                    pthread_mutex_unlock(&cout_mutex);
-
-                    // If more students are waiting, help the next one
-                    if (!chairs_queue.empty()) {
-                        int next_id = chairs_queue.front();
-                        chairs_queue.pop();
-                        office_chair.push(next_id);  // Move next student to the office
-                        int arrive2 = students_vector[next_id].getArrivalTime();
-                        students_vector[next_id].setWaitTime(now - arrive2);  // Calculate wait time
-                        help_start_time = now;  // Record when help started
-
-                        // Print message that TA starts helping next student
-                        pthread_mutex_lock(&cout_mutex);
-                        cout << "[T=" << now << "] TA starts helping S" << next_id << '\n';
-                        pthread_mutex_unlock(&cout_mutex);
-                    }
-                }
-            }
-        }
-
-        pthread_mutex_unlock(&queue_mutex);
+/* ========= Main Function ========= */
+int main(int argc, char* argv[]) {
+    int Total_minutes = 0;
+    int chairs = 0;
+    int student_count = 0;
+    char show;
+    bool Print_or_Not = false;
+    bool use_event_engine = false;
+    bool threads_requested = false;
+    int worker_count = thread::hardware_concurrency();
+    if (worker_count < 1) worker_count = 1;
+    int tick_us = 0;
+    int ta_count = 1;
+    string trace_out;
+    string trace_in;
+    string stats_out;
+    int stats_window = 60;
+    int replications = 0;
+    int jobs = 0;
+    DispatchSpec policy;
+
+    // +========== Options =========
+    if (argc > 1 && strcmp(argv[1], "--batch") == 0) {
+        return run_batch(argc, argv);
     }
-    return nullptr;  // Thread terminates
-}
-
-/* ========= Student Thread ========= */
-void* student_function(void* arg) {
-    // Cast the argument to a Student object pointer
-    Student* stu = static_cast<Student*>(arg);
-
-    while (true) {
-        // Lock the time mutex to safely access simulation state and time
-        pthread_mutex_lock(&time_mutex);
-        if (!simulation_running) {
-            pthread_mutex_unlock(&time_mutex);
-            return nullptr;  // Exit the thread if simulation is no longer running
-        }
-        // Wait for a tick signal (time update) before proceeding
-        pthread_cond_wait(&tick_cond, &time_mutex);
-        int now = current_time;  // Store the current simulation time
-        pthread_mutex_unlock(&time_mutex);
-
-        // Check if it's time for this student to arrive
-        if (stu->getArrivalTime() == now) {
-            // Lock the queue mutex to safely manage the waiting chairs
-            pthread_mutex_lock(&queue_mutex);
-            // Check if there are available chairs in the hallway
-            if ((int)chairs_queue.size() < chairs) {
-                chairs_queue.push(stu->getId());  // Student takes a seat in the hallway
-                stu->setStatement(2);  // Update student's state to waiting
-
-                // Print message that student arrives and takes a seat
-                pthread_mutex_lock(&cout_mutex);
-                cout << "[T=" << now << "] Student S" << stu->getId() << " arrives and takes a seat.\n";
-                pthread_mutex_unlock(&cout_mutex);
-
-                // If TA is sleeping, wake them up
-                if (TA_object.getStatement() == 0) {
-                    pthread_mutex_lock(&cout_mutex);
-                    cout << "[T=" << now << "] Student S" << stu->getId() << " wakes up TA.\n";
-                    pthread_mutex_unlock(&cout_mutex);
-                    sem_post(&ta_sleeping);  // Signal the TA semaphore to wake the TA
-                }
-            }
-            else {
-                // No seats available in the hallway, student will try again later
-                // Calculate a new arrival time for the student to return
-                int new_time = (now + 1 > Total_minutes) ?
-                               Total_minutes + 1 : getRandomTime(now + 1, Total_minutes);
-                stu->setArrivalTime(new_time);  // Update student's arrival time
-
-                pthread_mutex_lock(&cout_mutex);
-                if (new_time <= Total_minutes) {
-                    // Student will try again later within simulation time
-                    cout << "[T=" << now << "] Student S" << stu->getId()
-                         << " arrives but hall is full, will retry at " << new_time << " min.\n";
-                } else {
-                    // Not enough time left in simulation for student to return
-                    cout << "[T=" << now << "] Student S" << stu->getId()
-                         << " arrives but hall is full but time is not enough.( Just Leave )\n";
-                }
-                pthread_mutex_unlock(&cout_mutex);
-
-                // If new arrival time is after simulation ends, terminate student thread
-                if (new_time > Total_minutes) {
-                    pthread_mutex_unlock(&queue_mutex);
-                    return nullptr;
-                }
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--engine=event") == 0) {
+            use_event_engine = true;
+            threads_requested = false;
+        } else if (strcmp(argv[i], "--engine=threads") == 0) {
+            use_event_engine = false;
+            threads_requested = true;
+        } else if (strncmp(argv[i], "--workers=", 10) == 0 && atoi(argv[i] + 10) > 0) {
+            worker_count = atoi(argv[i] + 10);
+        } else if (strncmp(argv[i], "--tas=", 6) == 0 && atoi(argv[i] + 6) > 0) {
+            ta_count = atoi(argv[i] + 6);
+        } else if (strncmp(argv[i], "--seed=", 7) == 0) {
+            seedRandomTime(strtoull(argv[i] + 7, nullptr, 10));
+        } else if (strncmp(argv[i], "--trace=", 8) == 0) {
+            trace_in = argv[i] + 8;
+        } else if (strncmp(argv[i], "--trace-out=", 12) == 0) {
+            trace_out = argv[i] + 12;
+        } else if (strncmp(argv[i], "--stats-out=", 12) == 0) {
+            stats_out = argv[i] + 12;
+        } else if (strncmp(argv[i], "--stats-window=", 15) == 0 && atoi(argv[i] + 15) > 0) {
+            stats_window = atoi(argv[i] + 15);
+        } else if (strncmp(argv[i], "--replications=", 15) == 0 && atoi(argv[i] + 15) > 0) {
+            replications = atoi(argv[i] + 15);
+        } else if (strncmp(argv[i], "--jobs=", 7) == 0 && atoi(argv[i] + 7) > 0) {
+            jobs = atoi(argv[i] + 7);
+        } else if (strncmp(argv[i], "--policy=", 9) == 0) {
+            if (!policy.parse(argv[i] + 9)) {
+                cerr << "Unknown policy " << argv[i] + 9 << " (fifo, sqf, priority:QUICK or rr:QUANTUM)" << endl;
+                return 1;
             }
-            pthread_mutex_unlock(&queue_mutex);
+        } else if (strncmp(argv[i], "--tick-us=", 10) == 0) {
+            tick_us = atoi(argv[i] + 10);
+        } else {
+            cout << "Usage: " << argv[0] << " [--engine=threads|event] [--tas=N] [--policy=P] [--workers=N] [--seed=S] [--tick-us=U] [--trace=FILE] [--trace-out=FILE]\n"
+                 << "       " << string(strlen(argv[0]), ' ') << " [--stats-out=FILE] [--stats-window=W] [--replications=R [--jobs=N]]\n";
+            cout << "       " << argv[0] << " --batch [options]   (headless parameter sweep, see batch.h)\n";
+            cout << "  --engine=threads  student agents stepped by worker threads, one tick per simulated minute (default)\n";
+            cout << "  --engine=event    discrete-event simulation, jumps straight to the next event\n";
+            cout << "  --tas=N           number of TAs serving the hallway (default 1)\n";
+            cout << "  --policy=P        which waiting student a free TA takes (default fifo):\n"
+                 << "                    fifo, sqf (shortest question first), priority:QUICK (questions up to\n"
+                 << "                    QUICK minutes first) or rr:QUANTUM (help QUANTUM minutes, then back in line)\n";
+            cout << "  --workers=N       number of threads stepping the students, and at most as many for the TAs (default: number of cores)\n";
+            cout << "  --seed=S          seed the random times; the run is reproducible with any --workers, except that\n"
+                 << "                    several TA threads (--tas and --workers both above 1) take students as they get to them\n";
+            cout << "  --tick-us=U       sleep U microseconds before every tick (default 0: run as fast as possible)\n";
+            cout << "  --trace=FILE      replay arrivals from a CSV of arrival,question_time rows sorted by arrival\n"
+                 << "                    (event engine, streamed from disk, students are not prompted for)\n";
+            cout << "  --trace-out=FILE  threads engine: also write the log as binary records (see event_log.h)\n";
+            cout << "  --stats-out=FILE  write wait/turnaround histograms and the queue/utilisation time series\n";
+            cout << "  --stats-window=W  minutes per time series row (default 60)\n";
+            cout << "  --replications=R  run R independent replicas headless and print means with 95% confidence intervals\n";
+            cout << "  --jobs=N          replicas run at once (default: number of cores)\n";
+            return 1;
         }
     }
-    return nullptr;  // Thread terminates
-}
+    if (!trace_in.empty() && threads_requested) {
+        cerr << "--trace replays arrivals on the event engine, it cannot be combined with --engine=threads" << endl;
+        return 1;
+    }
 
-/* ========= Main Function ========= */
-int main() {
-    int student_count = 0;
-    char show;
-    bool Print_or_Not = false;
     // +========== Data Setting =========
     cout << "Enter number of chairs: " << endl;
     cin >> chairs;
-    cout << "Enter number of students: " << endl;
-    cin >> student_count;
+    if (trace_in.empty()) {
+        cout << "Enter number of students: " << endl;
+        cin >> student_count;
+    }
     cout << "Enter simulation time (minutes): " << endl;
     cin >> Total_minutes;
     cout << "Do you want to print every second statements (Y/N)?" << endl;
@@ -267,71 +124,107 @@ int main() {
 
     Print_or_Not = (show == 'Y');
 
-    for (int i = 0; i < student_count; i++) {
-        int qtime = getRandomTime(1, 5);
-        int atime = getRandomTime(0, Total_minutes);
-        students_vector.emplace_back(i, 1, qtime, atime);
-
-        cout << "Student S" << i
-             << "  Arrival: "  << atime << " min"
-             << "  Question: " << qtime << " min\n";
-
+    SimConfig config;
+    config.chairs   = chairs;
+    config.students = student_count;
+    config.minutes  = Total_minutes;
+    config.ta_count = ta_count;
+    config.policy   = policy;
+    if (replications > 0) {
+        run_replications(config, use_event_engine, replications, jobs, cout);
+        return 0;
     }
 
-    cout << "----------------------------------------\n";
-
-    sem_init(&ta_sleeping, 0, 0);
-    pthread_t ta_thread;
-    pthread_create(&ta_thread, nullptr, ta_function, nullptr);
-    vector<pthread_t> student_threads(student_count);
-
-    for (int i = 0; i < student_count; ++i){
-        pthread_create(&student_threads[i], nullptr, student_function, &students_vector[i]);
-    }
-    for (int tick = 0; tick < Total_minutes; tick++) {
-        usleep(200);  // 0.02 s → simulate 1 min
-        pthread_mutex_lock(&time_mutex);
-        current_time = tick + 1;
-        pthread_cond_broadcast(&tick_cond);
-        pthread_mutex_unlock(&time_mutex);
-        if(Print_or_Not){
-            print＿time_detail();
+    RunStats stats(stats_window, ta_count);
+    vector<TAStats> ta_stats;
+    if (!trace_in.empty()) {
+        // A trace is far too long to list or to keep in students_vector
+        ArrivalTrace trace;
+        if (!trace.open(trace_in)) {
+            cerr << trace.error() << endl;
+            return 1;
         }
-    }
-    pthread_mutex_lock(&time_mutex);
-    simulation_running = false;
-    pthread_cond_broadcast(&tick_cond);
-    pthread_mutex_unlock(&time_mutex);
-    sem_post(&ta_sleeping);
-    cout << "Simulation End\n";
-    pthread_join(ta_thread, nullptr);
-    for (auto& th : student_threads) pthread_join(th, nullptr);
-
-
-
-    int total_helped = 0, total_wait = 0, total_turn = 0, total_qtime = 0;
-    for (const auto& s : students_vector) {
-        if (s.wasHelped()) {
-            ++total_helped;
-            total_wait  += s.getWaitTime();
-            total_turn  += s.getTurnaroundTime();
-            total_qtime += s.getQuestionTime();
+        Xoshiro256 retry_rng = randomStream(1);
+        EventSimulator simulator(trace, chairs, Total_minutes, ta_count, retry_rng, &cout, Print_or_Not,
+                                 &stats, policy);
+        simulator.run();
+        if (!trace.error().empty()) {
+            cerr << trace_in << ": " << trace.error() << endl;
+            return 1;
         }
+        ta_stats = simulator.getTAStats();
+        student_count = simulator.getStudentCount();
+        cout << "Simulation End\n";
+    } else if (use_event_engine) {
+        Xoshiro256 student_rng = randomStream(0);
+        vector<Student> students_vector = makeStudents(config, student_rng);
+
+        for (const auto& s : students_vector) {
+            print_student(s.getId(), s.getArrivalTime(), s.getQuestionTime());
+        }
+        cout << "----------------------------------------\n";
+
+        for (auto& s : students_vector) s.attachStats(&stats);
+        Xoshiro256 retry_rng = randomStream(1);  // the stream of the first worker
+        EventSimulator simulator(students_vector, chairs, Total_minutes, ta_count, retry_rng, &cout, Print_or_Not,
+                                 &stats, policy);
+        simulator.run();
+        ta_stats = simulator.getTAStats();
+        cout << "Simulation End\n";
+    } else {
+        // The agents live only in the threaded engine's store
+        Xoshiro256 student_rng = randomStream(0);
+        StudentStore store(student_count, Total_minutes, &stats);
+        makeStudents(config, student_rng, store);
+
+        for (int sid = 0; sid < store.size(); ++sid) {
+            print_student(sid, store.getArrivalTime(sid), store.getQuestionTime(sid));
+        }
+        cout << "----------------------------------------\n";
+
+        ThreadSimOptions options;
+        options.ta_count     = ta_count;
+        options.workers      = worker_count;
+        options.tick_us      = tick_us;
+        options.print_detail = Print_or_Not;
+        options.trace_out    = trace_out;
+        options.policy       = policy;
+        if (!run_thread_simulation(store, chairs, Total_minutes, options, stats, ta_stats)) return 1;
     }
+    int total_ta_nap_time = 0;
+    for (const auto& st : ta_stats) total_ta_nap_time += st.nap_time;
 
+    SimResult result = summarize(student_count, stats, total_ta_nap_time);
 
     cout << "\n========= Simulation Summary =========\n";
-    cout << "Total Students       : " << students_vector.size()                << '\n';
-    cout << "Students Helped      : " << total_helped                          << '\n';
-    cout << "Students Not Helped  : " << students_vector.size() - total_helped << '\n';
-    if (total_helped) {
-        cout << "Average Question Time: " << (int)total_qtime / total_helped << " Minutes" << endl;
-        cout << "Average Wait Time    : " << (int)total_wait / total_helped << " Minutes" << endl;
-        cout << "Average Turnaround   : " << (int)total_turn / total_helped << " Minutes" << endl;
+    cout << "Total Students       : " << result.students                 << '\n';
+    cout << "Students Helped      : " << result.helped                   << '\n';
+    cout << "Students Not Helped  : " << result.students - result.helped << '\n';
+    cout << fixed << setprecision(2);
+    if (result.helped) {
+        cout << "Average Question Time: " << result.avg_question << " Minutes" << endl;
+        cout << "Average Wait Time    : " << result.avg_wait << " Minutes (p50 " << result.p50_wait
+             << ", p90 " << result.p90_wait << ", p99 " << result.p99_wait << ", max " << result.max_wait << ")" << endl;
+        cout << "Average Turnaround   : " << result.avg_turnaround << " Minutes (p50 " << stats.turnaround.percentile(50)
+             << ", p90 " << stats.turnaround.percentile(90) << ", p99 " << result.p99_turnaround
+             << ", max " << result.max_turnaround << ")" << endl;
     }
     cout << "TA Total Nap Time    : " << total_ta_nap_time << "Minutes" << endl;
+    if (ta_count > 1) {
+        for (int k = 0; k < ta_count; ++k) {
+            cout << taName(k, ta_count) << ": helped " << ta_stats[k].helped << " students, busy "
+                 << ta_stats[k].busy_time << " Minutes, napped " << ta_stats[k].nap_time << " Minutes\n";
+        }
+    }
     cout << "=============================\n";
 
-
+    if (!stats_out.empty()) {
+        ofstream file(stats_out);
+        if (!file.is_open()) {
+            cerr << "Failed to open " << stats_out << endl;
+            return 1;
+        }
+        stats.write(file);
+    }
     return 0;
 }
@@ -0,0 +1,147 @@
+#include "replication.h"
+#include "event_sim.h"
+#include "stats.h"
+#include "thread_sim.h"
+#include <atomic>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/* ========= Statistics ========= */
+// Two-sided 95% quantile of Student's t distribution
+static double t_quantile_975(int df) {
+    static const double table[] = {
+        0, 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+    if (df < 1)  return 0;
+    if (df <= 30) return table[df];
+    return 1.960 + 2.4 / df;    // within 0.005 of the exact value above 30
+}
+
+// Mean, standard deviation and confidence interval of one metric
+struct MetricSummary {
+    double mean = 0;
+    double stddev = 0;
+    double half_width = 0;
+
+    explicit MetricSummary(const vector<double>& samples) {
+        size_t n = samples.size();
+        if (n == 0) return;
+        for (double x : samples) mean += x;
+        mean /= n;
+        if (n < 2) return;
+        double squares = 0;
+        for (double x : samples) squares += (x - mean) * (x - mean);
+        stddev     = sqrt(squares / (n - 1));
+        half_width = t_quantile_975(n - 1) * stddev / sqrt((double)n);
+    }
+};
+
+/* ========= One Replica ========= */
+struct ReplicaResult {
+    SimResult summary;
+    double utilisation = 0;     // busy TA-minutes over available TA-minutes
+};
+
+static ReplicaResult run_replica(const SimConfig& config, bool event_engine, uint64_t seed) {
+    Xoshiro256 student_rng = randomStream(seed, 0);
+    RunStats stats(max(config.minutes, 1), config.ta_count);
+    vector<TAStats> ta_stats;
+
+    if (event_engine) {
+        vector<Student> students = makeStudents(config, student_rng);
+        for (auto& s : students) s.attachStats(&stats);
+        Xoshiro256 retry_rng = randomStream(seed, 1);
+        EventSimulator simulator(students, config.chairs, config.minutes, config.ta_count,
+                                 retry_rng, nullptr, false, &stats, config.policy);
+        simulator.run();
+        ta_stats = simulator.getTAStats();
+    } else {
+        ThreadSimOptions options;
+        options.ta_count = config.ta_count;
+        options.workers  = 1;
+        options.log      = nullptr;
+        options.seed     = seed;
+        options.policy   = config.policy;
+        StudentStore students(config.students, config.minutes, &stats);
+        makeStudents(config, student_rng, students);
+        run_thread_simulation(students, config.chairs, config.minutes, options, stats, ta_stats);
+    }
+
+    ReplicaResult result;
+    int nap = 0;
+    long long busy = 0;
+    for (const auto& t : ta_stats) {
+        nap  += t.nap_time;
+        busy += t.busy_time;
+    }
+    result.summary = summarize(config.students, stats, nap);
+    if (config.minutes > 0) result.utilisation = (double)busy / ((double)config.minutes * config.ta_count);
+    return result;
+}
+
+/* ========= Replication Run ========= */
+void run_replications(const SimConfig& config, bool event_engine, int replications, int jobs,
+                      ostream& out) {
+    // One seed per replica from the master stream; SplitMix64 spreads each
+    // over a whole generator state, so neighbouring replicas share nothing
+    vector<uint64_t> seeds(replications);
+    Xoshiro256 seeder = randomStream(0);
+    for (auto& seed : seeds) seed = seeder();
+
+    vector<ReplicaResult> results(replications);
+    atomic<int> next_replica{0};
+    auto worker = [&]() {
+        int r;
+        while ((r = next_replica++) < replications) {
+            results[r] = run_replica(config, event_engine, seeds[r]);
+        }
+    };
+    if (jobs < 1) jobs = thread::hardware_concurrency();
+    if (jobs < 1) jobs = 1;
+    if (jobs > replications) jobs = replications;
+    vector<thread> threads;
+    for (int j = 0; j < jobs; ++j) threads.emplace_back(worker);
+    for (auto& th : threads) th.join();
+
+    // One row per metric
+    struct Metric {
+        const char* name;
+        double (*get)(const ReplicaResult&);
+    };
+    static const Metric metrics[] = {
+        { "Students Helped",     [](const ReplicaResult& r) { return (double)r.summary.helped; } },
+        { "Average Question",    [](const ReplicaResult& r) { return r.summary.avg_question; } },
+        { "Average Wait",        [](const ReplicaResult& r) { return r.summary.avg_wait; } },
+        { "p90 Wait",            [](const ReplicaResult& r) { return (double)r.summary.p90_wait; } },
+        { "p99 Wait",            [](const ReplicaResult& r) { return (double)r.summary.p99_wait; } },
+        { "Average Turnaround",  [](const ReplicaResult& r) { return r.summary.avg_turnaround; } },
+        { "p99 Turnaround",      [](const ReplicaResult& r) { return (double)r.summary.p99_turnaround; } },
+        { "TA Total Nap Time",   [](const ReplicaResult& r) { return (double)r.summary.ta_nap_time; } },
+        { "TA Utilisation",      [](const ReplicaResult& r) { return r.utilisation; } },
+    };
+
+    out << "\n========= Replication Summary =========\n";
+    out << replications << " replications of " << config.students << " students, " << config.chairs
+        << " chairs, " << config.ta_count << " TA(s), " << config.minutes << " minutes ("
+        << (event_engine ? "event" : "threads") << " engine, " << config.policy.describe() << " policy)\n";
+    out << left << setw(22) << "Metric" << right << setw(12) << "Mean" << setw(12) << "Std Dev"
+        << setw(26) << "95% CI" << '\n';
+    out << fixed << setprecision(3);
+    for (const auto& m : metrics) {
+        vector<double> samples;
+        for (const auto& r : results) samples.push_back(m.get(r));
+        MetricSummary s(samples);
+        ostringstream ci;
+        ci << fixed << setprecision(3) << '[' << s.mean - s.half_width << ", " << s.mean + s.half_width << ']';
+        out << left << setw(22) << m.name << right << setw(12) << s.mean << setw(12) << s.stddev
+            << setw(26) << ci.str() << '\n';
+    }
+    out << "=============================\n";
+}
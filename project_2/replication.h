@@ -0,0 +1,19 @@
+#ifndef REPLICATION_H
+#define REPLICATION_H
+
+#include <iostream>
+#include "simulation.h"
+
+// Monte Carlo replication: runs the same configuration `replications` times
+// with decorrelated random streams, spread over `jobs` threads (0: one per
+// core), and writes the mean, standard deviation and 95% confidence
+// interval of each summary statistic to out.
+//
+// Replica r draws its students from stream 0 and its retries from stream 1
+// of the r-th seed of the master seed, so the whole table is reproducible
+// with --seed whatever the number of jobs. Threaded replicas run headless
+// with one worker each, the replicas themselves fill the cores.
+void run_replications(const SimConfig& config, bool event_engine, int replications, int jobs,
+                      std::ostream& out);
+
+#endif // REPLICATION_H
@@ -0,0 +1,99 @@
+#include "simulation.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+
+using namespace std;
+
+// --- QuestionDist ---
+
+bool QuestionDist::parse(const string& text) {
+    if (text.compare(0, 8, "uniform:") == 0) {
+        int a, b;
+        char dash;
+        istringstream ss(text.substr(8));
+        if (!(ss >> a >> dash >> b) || dash != '-' || a < 1 || b < a) return false;
+        kind = UNIFORM;
+        low  = a;
+        high = b;
+        return true;
+    }
+    if (text.compare(0, 4, "exp:") == 0) {
+        double m = atof(text.c_str() + 4);
+        if (m <= 0) return false;
+        kind = EXPONENTIAL;
+        mean = m;
+        return true;
+    }
+    return false;
+}
+
+string QuestionDist::describe() const {
+    ostringstream ss;
+    if (kind == UNIFORM) ss << "uniform:" << low << '-' << high;
+    else                 ss << "exp:" << mean;
+    return ss.str();
+}
+
+int QuestionDist::draw(Xoshiro256& engine) const {
+    if (kind == UNIFORM) return getRandomTime(engine, low, high);
+    // Inverse transform, the same on every standard library
+    double minutes = -mean * log(1.0 - engine.nextDouble());
+    return max(1, (int)ceil(minutes));
+}
+
+// --- Students and results ---
+
+string taName(int ta, int ta_count) {
+    return ta_count == 1 ? string("TA") : "TA" + to_string(ta);
+}
+
+// Question and arrival time of the next student
+static void drawStudent(const SimConfig& config, Xoshiro256& engine, int& qtime, int& atime) {
+    qtime = config.question.draw(engine);
+    // Ticks start at minute 1, an arrival at minute 0 would never happen
+    atime = getRandomTime(engine, min(1, config.minutes), config.minutes);
+}
+
+vector<Student> makeStudents(const SimConfig& config, Xoshiro256& engine) {
+    vector<Student> students;
+    students.reserve(config.students);
+    for (int i = 0; i < config.students; i++) {
+        int qtime, atime;
+        drawStudent(config, engine, qtime, atime);
+        students.emplace_back(i, 1, qtime, atime);
+    }
+    return students;
+}
+
+void makeStudents(const SimConfig& config, Xoshiro256& engine, StudentStore& store) {
+    for (int i = 0; i < config.students; i++) {
+        int qtime, atime;
+        drawStudent(config, engine, qtime, atime);
+        store.setStudent(i, qtime, atime);
+    }
+}
+
+int retryTime(uint64_t seed, int student, int now, int total_minutes) {
+    if (now + 1 > total_minutes) return total_minutes + 1;
+    Xoshiro256 engine = keyedStream(seed, student, now);
+    return getRandomTime(engine, now + 1, total_minutes);
+}
+
+SimResult summarize(int students, const RunStats& stats, int ta_nap_time) {
+    SimResult result;
+    result.students       = students;
+    result.helped         = stats.question.count();
+    result.ta_nap_time    = ta_nap_time;
+    result.avg_question   = stats.question.mean();
+    result.avg_wait       = stats.wait.mean();
+    result.p50_wait       = stats.wait.percentile(50);
+    result.p90_wait       = stats.wait.percentile(90);
+    result.p99_wait       = stats.wait.percentile(99);
+    result.max_wait       = stats.wait.max();
+    result.avg_turnaround = stats.turnaround.mean();
+    result.p99_turnaround = stats.turnaround.percentile(99);
+    result.max_turnaround = stats.turnaround.max();
+    return result;
+}
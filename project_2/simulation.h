@@ -0,0 +1,74 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <string>
+#include <vector>
+#include "helper.h"
+#include "stats.h"
+#include "dispatch.h"
+#include "student_store.h"
+
+// Distribution of the time (in minutes) a student's question takes
+struct QuestionDist {
+    enum Kind { UNIFORM, EXPONENTIAL };
+
+    Kind kind   = UNIFORM;
+    int low     = 1;        // uniform: inclusive bounds
+    int high    = 5;
+    double mean = 3.0;      // exponential: mean, rounded up to whole minutes
+
+    // "uniform:1-5" or "exp:3"
+    bool parse(const std::string& text);
+    std::string describe() const;
+    int draw(Xoshiro256& engine) const;
+};
+
+// Per-TA counters of one simulation run
+struct TAStats {
+    int helped    = 0;  // students helped to the end of their question
+    int busy_time = 0;  // minutes with a student in the office
+    int nap_time  = 0;  // minutes asleep
+};
+
+// Parameters of one simulation run
+struct SimConfig {
+    int chairs   = 0;
+    int students = 0;
+    int minutes  = 0;
+    int ta_count = 1;
+    QuestionDist question;
+    DispatchSpec policy;
+};
+
+// Summary statistics of one simulation run
+struct SimResult {
+    int students      = 0;
+    int helped        = 0;
+    double avg_question   = 0;
+    double avg_wait       = 0;     // of helped students
+    int p50_wait          = 0;
+    int p90_wait          = 0;
+    int p99_wait          = 0;
+    int max_wait          = 0;
+    double avg_turnaround = 0;
+    int p99_turnaround    = 0;
+    int max_turnaround    = 0;
+    int ta_nap_time       = 0;  // summed over all TAs
+};
+
+// "TA" when there is only one, "TA0", "TA1", ... otherwise
+std::string taName(int ta, int ta_count);
+
+// Draw the question and arrival time of every student
+std::vector<Student> makeStudents(const SimConfig& config, Xoshiro256& engine);
+// Same draws straight into a store of config.students students
+void makeStudents(const SimConfig& config, Xoshiro256& engine, StudentStore& store);
+
+// Minute a student turned away at now comes back, total_minutes + 1 if
+// there is no time left. Keyed on the student and now, so both engines and
+// any number of threads draw the same times.
+int retryTime(uint64_t seed, int student, int now, int total_minutes);
+
+SimResult summarize(int students, const RunStats& stats, int ta_nap_time);
+
+#endif // SIMULATION_H
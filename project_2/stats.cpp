@@ -0,0 +1,114 @@
+#include "stats.h"
+#include <algorithm>
+#include <iomanip>
+
+using namespace std;
+
+// --- LatencyHistogram ---
+
+LatencyHistogram::LatencyHistogram() {
+    for (auto& c : counts) c.store(0, memory_order_relaxed);
+}
+
+int LatencyHistogram::bucketOf(int value) {
+    if (value < SUB_BUCKETS) return value;
+    int msb   = 31 - __builtin_clz((unsigned)value);
+    int shift = msb - SUB_BITS + 1;     // >= 1
+    int top   = value >> shift;         // in [HALF, SUB_BUCKETS)
+    return SUB_BUCKETS + (shift - 1) * HALF + (top - HALF);
+}
+
+int LatencyHistogram::bucketLow(int bucket) {
+    if (bucket < SUB_BUCKETS) return bucket;
+    int shift = (bucket - SUB_BUCKETS) / HALF + 1;
+    int top   = (bucket - SUB_BUCKETS) % HALF + HALF;
+    return top << shift;
+}
+
+int LatencyHistogram::bucketHigh(int bucket) {
+    if (bucket < SUB_BUCKETS) return bucket;
+    int shift = (bucket - SUB_BUCKETS) / HALF + 1;
+    return bucketLow(bucket) + ((1 << shift) - 1);
+}
+
+void LatencyHistogram::record(int value) {
+    if (value < 0) value = 0;
+    counts[bucketOf(value)].fetch_add(1, memory_order_relaxed);
+    total.fetch_add(1, memory_order_relaxed);
+    sum.fetch_add(value, memory_order_relaxed);
+    int seen = max_value.load(memory_order_relaxed);
+    while (value > seen && !max_value.compare_exchange_weak(seen, value, memory_order_relaxed)) {}
+}
+
+double LatencyHistogram::mean() const {
+    uint64_t n = count();
+    return n ? (double)sum.load() / n : 0.0;
+}
+
+int LatencyHistogram::percentile(double p) const {
+    uint64_t n = count();
+    if (n == 0) return 0;
+    uint64_t rank = (uint64_t)(p / 100.0 * n + 0.5);
+    if (rank < 1) rank = 1;
+    uint64_t seen = 0;
+    for (int b = 0; b < BUCKETS; ++b) {
+        seen += counts[b].load(memory_order_relaxed);
+        if (seen >= rank) return min(bucketHigh(b), max());
+    }
+    return max();
+}
+
+void LatencyHistogram::write(ostream& out, const char* name) const {
+    out << "# histogram " << name << ": count " << count() << ", mean " << mean()
+        << ", p50 " << percentile(50) << ", p90 " << percentile(90) << ", p99 " << percentile(99)
+        << ", p99.9 " << percentile(99.9) << ", max " << max() << '\n';
+    out << "low,high,count\n";
+    for (int b = 0; b < BUCKETS; ++b) {
+        uint64_t c = counts[b].load(memory_order_relaxed);
+        if (c) out << bucketLow(b) << ',' << bucketHigh(b) << ',' << c << '\n';
+    }
+}
+
+// --- TimeSeries ---
+
+TimeSeries::TimeSeries(int window_, int ta_count_)
+    : window(window_ > 0 ? window_ : 1), ta_count(ta_count_) {}
+
+void TimeSeries::record(int first, int last, int queue_length, int busy_tas) {
+    if (first < 1 || last < first) return;
+    if ((int)windows.size() <= (last - 1) / window) windows.resize((last - 1) / window + 1);
+    // Add the whole span window by window
+    while (first <= last) {
+        int w   = (first - 1) / window;
+        int end = min(last, (w + 1) * window);
+        int n   = end - first + 1;
+        Window& win = windows[w];
+        win.ticks     += n;
+        win.queue_sum += (long long)queue_length * n;
+        win.queue_max  = std::max(win.queue_max, queue_length);
+        win.busy_sum  += (long long)busy_tas * n;
+        first = end + 1;
+    }
+}
+
+void TimeSeries::write(ostream& out) const {
+    out << "# time series: " << window << " minute windows\n";
+    out << "first_minute,last_minute,avg_queue,max_queue,ta_utilisation\n";
+    for (size_t w = 0; w < windows.size(); ++w) {
+        const Window& win = windows[w];
+        if (win.ticks == 0) continue;
+        out << w * window + 1 << ',' << w * window + win.ticks << ','
+            << (double)win.queue_sum / win.ticks << ',' << win.queue_max << ','
+            << (double)win.busy_sum / ((double)win.ticks * ta_count) << '\n';
+    }
+}
+
+// --- RunStats ---
+
+void RunStats::write(ostream& out) const {
+    out << fixed << setprecision(3);
+    wait.write(out, "wait");
+    turnaround.write(out, "turnaround");
+    question.write(out, "question");
+    series.write(out);
+}
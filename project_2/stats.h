@@ -0,0 +1,88 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+// Log-linear histogram of non-negative integer times (HDR histogram style).
+//
+// Values below 2^SUB_BITS get a bucket each. Above that every power of two
+// is split into 2^(SUB_BITS-1) equal buckets, so any recorded value is known
+// to within 1/128 of itself. The buckets are a fixed array of atomic
+// counters: several threads can record at once and memory does not grow
+// with the number of values.
+class LatencyHistogram {
+    private:
+        static const int SUB_BITS    = 8;
+        static const int SUB_BUCKETS = 1 << SUB_BITS;
+        static const int HALF        = SUB_BUCKETS / 2;
+        static const int BUCKETS     = SUB_BUCKETS + (31 - SUB_BITS + 1) * HALF;
+
+        std::atomic<uint64_t> counts[BUCKETS];
+        std::atomic<uint64_t> total{0};
+        std::atomic<int64_t>  sum{0};
+        std::atomic<int>      max_value{0};
+
+        static int bucketOf(int value);
+        static int bucketLow(int bucket);
+        static int bucketHigh(int bucket);
+
+    public:
+        LatencyHistogram();
+        LatencyHistogram(const LatencyHistogram&) = delete;
+        LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+        void record(int value);
+
+        uint64_t count() const { return total.load(); }
+        double mean() const;
+        int max() const { return max_value.load(); }
+        // Smallest bucket bound at or below which p percent of the values lie
+        int percentile(double p) const;
+
+        // "low,high,count" for every non-empty bucket
+        void write(std::ostream& out, const char* name) const;
+};
+
+// Queue length and TA utilisation per window of simulated minutes.
+// Only the per-window sums are kept, one row per window.
+class TimeSeries {
+    private:
+        struct Window {
+            int ticks = 0;
+            long long queue_sum = 0;
+            int queue_max = 0;
+            long long busy_sum = 0;     // busy TA-minutes
+        };
+
+        int window;
+        int ta_count;
+        std::vector<Window> windows;
+
+    public:
+        TimeSeries(int window_, int ta_count_);
+
+        // State at the end of every minute in [first, last]
+        void record(int first, int last, int queue_length, int busy_tas);
+        void record(int tick, int queue_length, int busy_tas) { record(tick, tick, queue_length, busy_tas); }
+
+        void write(std::ostream& out) const;
+};
+
+// Everything measured while a simulation runs. Students report their times
+// through Student::attachStats, the engine samples the time series.
+struct RunStats {
+    LatencyHistogram wait;          // helped students
+    LatencyHistogram turnaround;    // helped students
+    LatencyHistogram question;      // helped students
+    TimeSeries series;
+
+    RunStats(int window, int ta_count) : series(window, ta_count) {}
+
+    // Histograms and time series in one text file, sections start with "# "
+    void write(std::ostream& out) const;
+};
+
+#endif // STATS_H
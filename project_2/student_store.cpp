@@ -0,0 +1,56 @@
+#include "student_store.h"
+#include <algorithm>
+
+using namespace std;
+
+// --- StudentStore ---
+
+StudentStore::StudentStore(int count, int total_minutes, RunStats* stats_)
+    : state(count, 1), helped(count, 0), question_time(count, 0), arrival_time(count, -1),
+      wait_time(count, 0), turnaround_time(count, 0), next_arrival(count, -1),
+      bucket(total_minutes + 2), stats(stats_) {
+    for (auto& head : bucket) head.store(-1, memory_order_relaxed);
+}
+
+void StudentStore::setStudent(int sid, int question_time_, int arrival_time_) {
+    state[sid]         = 1;
+    question_time[sid] = question_time_;
+    arrival_time[sid]  = arrival_time_;
+    scheduleArrival(sid, arrival_time_);
+}
+
+void StudentStore::takeArrivals(int tick, vector<int32_t>& out) {
+    out.clear();
+    if (tick < 0 || tick >= (int)bucket.size()) return;
+    for (int32_t sid = bucket[tick].exchange(-1, memory_order_acquire); sid != -1; sid = next_arrival[sid]) {
+        out.push_back(sid);
+    }
+    // The list order depends on who pushed first, students step in id order
+    sort(out.begin(), out.end());
+}
+
+void StudentStore::scheduleArrival(int sid, int tick) {
+    if (tick < 0 || tick >= (int)bucket.size()) return;   // never arrives
+    // Lock-free push onto the front of the bucket
+    int32_t head = bucket[tick].load(memory_order_relaxed);
+    do {
+        next_arrival[sid] = head;
+    } while (!bucket[tick].compare_exchange_weak(head, sid, memory_order_release, memory_order_relaxed));
+}
+
+void StudentStore::setWaitTime(int sid, int w) {
+    wait_time[sid] = w;
+}
+
+void StudentStore::setTurnaroundTime(int sid, int t) {
+    turnaround_time[sid] = t;
+    if (stats) stats->turnaround.record(t);
+}
+
+void StudentStore::setHelped(int sid) {
+    helped[sid] = 1;
+    if (stats) {
+        stats->wait.record(wait_time[sid]);
+        stats->question.record(question_time[sid]);
+    }
+}
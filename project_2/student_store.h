@@ -0,0 +1,60 @@
+#ifndef STUDENT_STORE_H
+#define STUDENT_STORE_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "stats.h"
+
+// Structure-of-arrays store of the student agents of the threaded engine.
+//
+// Every field lives in its own tightly packed array (one byte for the state
+// and the helped flag, 32 bits for times and links), so stepping a million
+// agents touches only the bytes it needs. Students are also indexed by the
+// tick of their next arrival: each tick owns an intrusive list threaded
+// through next_arrival, and a tick only visits the students arriving in it
+// instead of polling every agent.
+class StudentStore {
+    private:
+        std::vector<uint8_t> state;         // 1 coding, 2 seeking help, 3 left without help
+        std::vector<uint8_t> helped;
+        std::vector<int32_t> question_time;
+        std::vector<int32_t> arrival_time;
+        std::vector<int32_t> wait_time;
+        std::vector<int32_t> turnaround_time;
+
+        // Arrival index: bucket[t] heads the list of students arriving at t
+        std::vector<int32_t> next_arrival;  // -1 ends a list
+        std::vector<std::atomic<int32_t> > bucket;
+
+        RunStats* stats;
+
+    public:
+        // Room for count students, filled in with setStudent before the run.
+        // Times are recorded into stats (may be nullptr).
+        StudentStore(int count, int total_minutes, RunStats* stats_);
+        StudentStore(const StudentStore&) = delete;
+        StudentStore& operator=(const StudentStore&) = delete;
+
+        int size() const { return state.size(); }
+        // A coding student who comes to the hallway at arrival_time
+        void setStudent(int sid, int question_time_, int arrival_time_);
+
+        // --- Arrival index ---
+        // Students arriving at tick, in id order. Empties the bucket.
+        void takeArrivals(int tick, std::vector<int32_t>& out);
+        // Queue sid for a later tick. Safe to call from several threads at once.
+        void scheduleArrival(int sid, int tick);
+
+        // --- Agent fields ---
+        int getStatement(int sid) const      { return state[sid]; }
+        void setStatement(int sid, int s)    { state[sid] = s; }
+        int getQuestionTime(int sid) const   { return question_time[sid]; }
+        int getArrivalTime(int sid) const    { return arrival_time[sid]; }
+        void setArrivalTime(int sid, int t)  { arrival_time[sid] = t; }
+        void setWaitTime(int sid, int w);
+        void setTurnaroundTime(int sid, int t);
+        void setHelped(int sid);
+};
+
+#endif // STUDENT_STORE_H
@@ -0,0 +1,379 @@
+#include "thread_sim.h"
+#include <pthread.h>
+#include <semaphore.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <set>
+#include "tick_barrier.h"
+#include "dispatch.h"
+#include "event_log.h"
+#include "student_store.h"
+
+using namespace std;
+
+/* ========= Data Structures ========= */
+// One TA agent. Only the TA thread owning the agent touches its fields,
+// students reach it through sleeping_tas and its wake semaphore.
+struct TAAgent {
+    TA state{1};
+    int office          = -1;   // student being helped, -1 if none
+    int session         = 0;    // minutes this help session lasts
+    int remaining       = 0;    // minutes the student still needs after it
+    int help_start_time = -1;
+    int nap_start_time  = -1;
+    sem_t wake;                 // posted by the student who wakes this TA
+    TAStats stats;
+};
+
+// Everything one run shares between its threads. Each run owns its own
+// context, so several simulations can run in one process at once.
+struct SimContext {
+    int Total_minutes = 0;
+    int current_time  = 0;
+    int chairs        = 0;
+    uint64_t retry_seed = 0;    // key of the retry times, see retryTime
+
+    pthread_mutex_t sleep_mutex;                    // sleeping_tas
+    atomic<unsigned long long> lock_waits{0};       // lock() calls that found the mutex taken
+
+    vector<TAAgent> ta_agents;
+    set<int> sleeping_tas;                  // sleeping TAs nobody is waking yet
+    StudentStore* student_store = nullptr;  // agent state while the threads run
+    vector<int32_t> tick_arrivals;          // students arriving this tick, in id order
+    vector<int> tick_seats;                 // what seat_arrivals decided for each of them
+    DispatchPolicy* chairs_queue = nullptr; // sized to chairs, safe to share
+    EventLog* event_log = nullptr;          // written by a background thread
+
+    SimContext()  { pthread_mutex_init(&sleep_mutex, nullptr); }
+    ~SimContext() { pthread_mutex_destroy(&sleep_mutex); }
+};
+
+/* ========= Synchronization Primitives ========= */
+// Lock, counting the times another thread held the mutex
+static void lock_counted(SimContext& ctx, pthread_mutex_t* mutex) {
+    if (pthread_mutex_trylock(mutex) != 0) {
+        ctx.lock_waits.fetch_add(1, memory_order_relaxed);
+        pthread_mutex_lock(mutex);
+    }
+}
+
+/* ========= Printting Detail ========= */
+// Called between ticks, when no student or TA thread is running.
+// The log writer formats the snapshot after the lines of the tick.
+static void print＿time_detail(SimContext& ctx) {
+    DetailSnapshot detail;
+    detail.time   = ctx.current_time;
+    detail.chairs = ctx.chairs;
+    detail.hall   = ctx.chairs_queue->snapshot();
+    for (const auto& ta : ctx.ta_agents) {
+        detail.ta_state.push_back(ta.state.getStatement());
+        detail.office.push_back(ta.office);
+    }
+    ctx.event_log->pushDetail(move(detail));
+}
+
+
+/* ========= TA Threads ========= */
+// Move the next waiting student into TA k's office.
+// Returns false if nobody is waiting.
+static bool ta_start_helping(SimContext& ctx, int k, int now, EventLog::Ring& log) {
+    TAAgent& ta = ctx.ta_agents[k];
+
+    // The hallway is the only state shared between TAs
+    int sid, remaining;
+    if (!ctx.chairs_queue->tryPop(sid, remaining)) return false;  // Get next waiting student
+
+    ta.office = sid;  // Move student to the office
+    ta.session   = ctx.chairs_queue->slice(remaining);
+    ta.remaining = remaining - ta.session;
+    if (remaining == ctx.student_store->getQuestionTime(sid)) {  // First session ends the wait
+        int arrive = ctx.student_store->getArrivalTime(sid);
+        ctx.student_store->setWaitTime(sid, now - arrive);  // Calculate wait time
+    }
+    ta.help_start_time = now;  // Record when help started
+
+    log.push(now, LOG_TA_START, sid, k);  // Log that TA starts helping a student
+    return true;
+}
+
+// Advance TA k by one tick. Runs after all students have stepped this tick.
+static void ta_step(SimContext& ctx, int k, int now, EventLog::Ring& log) {
+    TAAgent& ta = ctx.ta_agents[k];
+
+    if (ta.state.getStatement() == 0) {  // TA is sleeping
+        // Wake up if a student signalled the semaphore
+        if (sem_trywait(&ta.wake) == 0) {
+            ta.stats.nap_time += now - ta.nap_start_time;  // Track total nap time
+            ta.state.setStatement(1);  // TA is now active
+            log.push(now, LOG_TA_WAKE, -1, k);  // Log that TA woke up
+            ta_start_helping(ctx, k, now, log);  // Help a waiting student, if any
+        }
+    }
+    else if (ta.office == -1) {  // No student currently being helped
+        if (!ta_start_helping(ctx, k, now, log)) {  // No students waiting in the hallway
+            ta.state.setStatement(0);  // TA goes to sleep
+            ta.nap_start_time = now;  // Record when TA starts napping
+            lock_counted(ctx, &ctx.sleep_mutex);
+            ctx.sleeping_tas.insert(k);
+            pthread_mutex_unlock(&ctx.sleep_mutex);
+            log.push(now, LOG_TA_SLEEP, -1, k);  // Log that TA is sleeping
+        }
+    }
+    else {
+        // TA is currently helping a student, check if the session is over
+        int sid = ta.office;
+
+        // Check if the help session is complete
+        if (ta.help_start_time != -1 && now - ta.help_start_time >= ta.session) {
+            ta.office = -1;  // Student leaves the office
+            ta.stats.busy_time += now - ta.help_start_time;
+            ta.help_start_time = -1;  // Reset help start time
+
+            if (ta.remaining > 0) {
+                // The policy cut the session short, the student waits for the rest
+                ctx.chairs_queue->requeue(sid, ta.remaining);
+                log.push(now, LOG_REQUEUE, sid, k, ta.remaining);
+            } else {
+                ctx.student_store->setHelped(sid);  // Mark student as helped
+                int arrive = ctx.student_store->getArrivalTime(sid);
+                ctx.student_store->setTurnaroundTime(sid, now - arrive);  // Calculate total time in system
+                ta.stats.helped++;
+
+                log.push(now, LOG_FINISH, sid, k);  // Log that student finished and leaves
+            }
+
+            // If more students are waiting, help the next one
+            ta_start_helping(ctx, k, now, log);
+        }
+    }
+}
+
+// Each TA thread owns a contiguous range [first, last) of the TA agents
+struct TAShard {
+    SimContext* ctx;
+    int first;
+    int last;
+    TickBarrier* phase;
+    EventLog::Ring* log;    // this thread's log ring
+};
+
+static void* ta_function(void* arg){
+    TAShard* shard = static_cast<TAShard*>(arg);
+    SimContext& ctx = *shard->ctx;
+    unsigned long seen_generation = 0;
+    int now;
+    // Process every TA phase tick exactly once
+    while (shard->phase->awaitTick(seen_generation, now)) {
+        for (int k = shard->first; k < shard->last; ++k) {
+            ta_step(ctx, k, now, *shard->log);
+        }
+        shard->phase->finishTick();
+    }
+
+    // The end of the simulation wakes sleeping TAs and interrupts help sessions
+    for (int k = shard->first; k < shard->last; ++k) {
+        TAAgent& ta = ctx.ta_agents[k];
+        if (ta.state.getStatement() == 0) ta.stats.nap_time += ctx.Total_minutes - ta.nap_start_time;
+        if (ta.office != -1)              ta.stats.busy_time += ctx.Total_minutes - ta.help_start_time;
+    }
+    return nullptr;  // Thread terminates
+}
+
+/* ========= Student Agents ========= */
+// What seat_arrivals decided for an arrival. A TA index (>= 0) means the
+// student is seated and wakes that TA.
+enum { SEAT_NONE = -3, SEAT_REFUSED = -2, SEAT_NO_WAKE = -1 };
+
+// Seat this tick's arrivals in id order, between the phases. Who gets the
+// last chairs and which TA each student wakes so never depends on how the
+// workers are scheduled; the workers then step the students in parallel.
+static void seat_arrivals(SimContext& ctx, int now) {
+    StudentStore& store = *ctx.student_store;
+    ctx.tick_seats.assign(ctx.tick_arrivals.size(), SEAT_NONE);
+    for (size_t i = 0; i < ctx.tick_arrivals.size(); ++i) {
+        int sid = ctx.tick_arrivals[i];
+        // Only coding students can arrive at the hallway
+        if (store.getStatement(sid) != 1 || store.getArrivalTime(sid) != now) continue;
+
+        // Take a chair if one is free
+        if (!ctx.chairs_queue->tryPush(sid, store.getQuestionTime(sid))) {
+            ctx.tick_seats[i] = SEAT_REFUSED;
+            continue;
+        }
+        // If a TA is sleeping, wake up the lowest numbered one nobody is waking yet
+        int k = SEAT_NO_WAKE;
+        lock_counted(ctx, &ctx.sleep_mutex);
+        if (!ctx.sleeping_tas.empty()) {
+            k = *ctx.sleeping_tas.begin();
+            ctx.sleeping_tas.erase(ctx.sleeping_tas.begin());
+        }
+        pthread_mutex_unlock(&ctx.sleep_mutex);
+        ctx.tick_seats[i] = k;
+    }
+}
+
+// Step the i-th student arriving at the hallway this tick.
+// Students are state machines: 1 = coding until the arrival time,
+// 2 = waiting in the hallway or being helped, 3 = left without help.
+static void step_student(SimContext& ctx, size_t i, int now, EventLog::Ring& log) {
+    StudentStore& store = *ctx.student_store;
+    int sid  = ctx.tick_arrivals[i];
+    int seat = ctx.tick_seats[i];
+    if (seat == SEAT_NONE) return;
+
+    if (seat != SEAT_REFUSED) {
+        store.setStatement(sid, 2);  // Update student's state to waiting
+
+        log.push(now, LOG_SEAT, sid);  // Log that student arrives and takes a seat
+        if (seat != SEAT_NO_WAKE) {
+            log.push(now, LOG_STUDENT_WAKES, sid, seat);
+            sem_post(&ctx.ta_agents[seat].wake);  // Signal the TA semaphore to wake the TA
+        }
+    }
+    else {
+        // No seats available in the hallway, student will try again later
+        // Calculate a new arrival time for the student to return
+        int new_time = retryTime(ctx.retry_seed, sid, now, ctx.Total_minutes);
+        store.setArrivalTime(sid, new_time);  // Update student's arrival time
+        store.scheduleArrival(sid, new_time);
+
+        if (new_time <= ctx.Total_minutes) {
+            // Student will try again later within simulation time
+            log.push(now, LOG_RETRY, sid, -1, new_time);
+        } else {
+            // Not enough time left in simulation for student to return
+            log.push(now, LOG_LEAVE, sid);
+        }
+
+        // If new arrival time is after simulation ends, the student is done
+        if (new_time > ctx.Total_minutes) {
+            store.setStatement(sid, 3);
+        }
+    }
+}
+
+/* ========= Worker Thread ========= */
+// Worker w of count steps the w-th contiguous slice of tick_arrivals, so
+// the workers' log rings together keep the students in id order
+struct StudentShard {
+    SimContext* ctx;
+    int worker;
+    int count;
+    TickBarrier* phase;
+    EventLog::Ring* log;    // this thread's log ring
+};
+
+static void* worker_function(void* arg) {
+    StudentShard* shard = static_cast<StudentShard*>(arg);
+    SimContext& ctx = *shard->ctx;
+    unsigned long seen_generation = 0;
+    int now;
+
+    // Process every student phase tick exactly once
+    while (shard->phase->awaitTick(seen_generation, now)) {
+        size_t n     = ctx.tick_arrivals.size();
+        size_t first = n * shard->worker / shard->count;
+        size_t last  = n * (shard->worker + 1) / shard->count;
+        for (size_t i = first; i < last; ++i) {
+            step_student(ctx, i, now, *shard->log);
+        }
+        shard->phase->finishTick();
+    }
+    return nullptr;  // Thread terminates
+}
+
+/* ========= Threaded Simulation ========= */
+// A pool of TA threads stepping the TA agents plus a pool of workers
+// stepping the students. Each tick has two phases separated by barriers:
+// first every student steps, then every TA, so the TAs always see every
+// arrival of the tick. The controller seats the arrivals in id order
+// before the student phase. Every thread logs into its own ring and never waits
+// for the terminal.
+bool run_thread_simulation(StudentStore& store, int chairs_, int total_minutes,
+                           const ThreadSimOptions& options, RunStats& stats,
+                           vector<TAStats>& ta_stats, ThreadSimCounters* counters) {
+    SimContext ctx;
+    ctx.Total_minutes = total_minutes;
+    ctx.chairs        = chairs_;
+    ctx.retry_seed    = randomStream(options.seed, 1)();  // stream 0 made the students
+    int ta_count     = options.ta_count;
+    int worker_count = min<int>(options.workers, store.size());
+    int ta_threads_count = min(ta_count, options.workers);
+
+    // Rings in log order: student workers first, then the TA threads
+    EventLog log(worker_count + ta_threads_count, ta_count, options.log);
+    if (!options.trace_out.empty() && !log.openTrace(options.trace_out)) {
+        cerr << "Failed to open " << options.trace_out << endl;
+        return false;
+    }
+    log.start();
+    ctx.event_log = &log;
+
+    unique_ptr<DispatchPolicy> hallway = makeDispatchPolicy(options.policy, ctx.chairs, store.size());
+    ctx.chairs_queue = hallway.get();
+    ctx.student_store = &store;
+    ctx.ta_agents = vector<TAAgent>(ta_count);
+    ctx.sleeping_tas.clear();
+    for (auto& ta : ctx.ta_agents) sem_init(&ta.wake, 0, 0);
+
+    // Split the TAs, and each tick's arrivals, into one contiguous shard per thread
+    TickBarrier ta_phase(ta_threads_count);
+    vector<TAShard> ta_shards(ta_threads_count);
+    vector<pthread_t> ta_threads(ta_threads_count);
+    for (int t = 0; t < ta_threads_count; ++t) {
+        ta_shards[t].ctx   = &ctx;
+        ta_shards[t].first = (long long)t * ta_count / ta_threads_count;
+        ta_shards[t].last  = (long long)(t + 1) * ta_count / ta_threads_count;
+        ta_shards[t].phase = &ta_phase;
+        ta_shards[t].log   = &log.ring(worker_count + t);
+        pthread_create(&ta_threads[t], nullptr, ta_function, &ta_shards[t]);
+    }
+
+    TickBarrier student_phase(worker_count);
+    vector<StudentShard> shards(worker_count);
+    vector<pthread_t> worker_threads(worker_count);
+    for (int w = 0; w < worker_count; ++w) {
+        shards[w].ctx    = &ctx;
+        shards[w].worker = w;
+        shards[w].count  = worker_count;
+        shards[w].phase  = &student_phase;
+        shards[w].log    = &log.ring(w);
+        pthread_create(&worker_threads[w], nullptr, worker_function, &shards[w]);
+    }
+    for (int tick = 0; tick < ctx.Total_minutes; tick++) {
+        if (options.tick_us > 0) usleep(options.tick_us);  // Optional real-time pacing
+        ctx.current_time = tick + 1;
+        store.takeArrivals(ctx.current_time, ctx.tick_arrivals);
+        seat_arrivals(ctx, ctx.current_time);
+        student_phase.runTick(ctx.current_time);
+        ta_phase.runTick(ctx.current_time);
+        if (options.print_detail && options.log) {
+            print＿time_detail(ctx);
+        }
+        log.publish(ctx.current_time);
+
+        // Sample the office once the tick is complete
+        int busy = 0;
+        for (const auto& ta : ctx.ta_agents) busy += ta.office != -1;
+        stats.series.record(ctx.current_time, ctx.chairs_queue->size(), busy);
+    }
+    student_phase.stop();
+    ta_phase.stop();
+    for (auto& th : ta_threads) pthread_join(th, nullptr);
+    for (auto& th : worker_threads) pthread_join(th, nullptr);
+    log.close();  // Wait until every line is written
+    if (options.log) *options.log << "Simulation End\n";
+
+    ta_stats.clear();
+    for (auto& ta : ctx.ta_agents) {
+        ta_stats.push_back(ta.stats);
+        sem_destroy(&ta.wake);
+    }
+    if (counters) {
+        counters->events       = log.recordCount();
+        counters->lock_waits   = ctx.lock_waits.load();
+        counters->hall_retries = hallway->contention();
+    }
+    return true;
+}
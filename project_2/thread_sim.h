@@ -0,0 +1,40 @@
+#ifndef THREAD_SIM_H
+#define THREAD_SIM_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "helper.h"
+#include "simulation.h"
+#include "stats.h"
+#include "student_store.h"
+
+// Options of the threaded simulation
+struct ThreadSimOptions {
+    int ta_count      = 1;
+    int workers       = 1;          // threads stepping the students, at most as many for the TAs
+    int tick_us       = 0;          // sleep before every tick, 0: as fast as possible
+    bool print_detail = false;      // office state after every tick
+    std::ostream* log = &std::cout; // nullptr: run headless
+    std::string trace_out;          // binary trace file, empty: none
+    uint64_t seed = masterSeed();   // stream 1 of it keys the retry times
+    DispatchSpec policy;            // order students leave the hallway in
+};
+
+// What one threaded run cost
+struct ThreadSimCounters {
+    unsigned long long events       = 0;    // logged events
+    unsigned long long lock_waits   = 0;    // lock attempts that found the mutex taken
+    unsigned long long hall_retries = 0;    // failed CAS on the hallway ring, or lock waits of a locked policy
+};
+
+// Run the threaded simulation of the students, one tick per simulated
+// minute, filling in their times and the per-TA counters. The store is made
+// for total_minutes and used up by the run; its times go to stats. All
+// state of the run lives in a context of its own, so several runs may go
+// on at once. Returns false if the trace file cannot be opened.
+bool run_thread_simulation(StudentStore& students, int chairs, int total_minutes,
+                           const ThreadSimOptions& options, RunStats& stats,
+                           std::vector<TAStats>& ta_stats, ThreadSimCounters* counters = nullptr);
+
+#endif // THREAD_SIM_H
@@ -0,0 +1,55 @@
+#include "tick_barrier.h"
+
+// --- TickBarrier ---
+
+TickBarrier::TickBarrier(int parties_) : parties(parties_) {
+    pthread_mutex_init(&mutex, nullptr);
+    pthread_cond_init(&tick_cond, nullptr);
+    pthread_cond_init(&done_cond, nullptr);
+}
+
+TickBarrier::~TickBarrier() {
+    pthread_cond_destroy(&done_cond);
+    pthread_cond_destroy(&tick_cond);
+    pthread_mutex_destroy(&mutex);
+}
+
+void TickBarrier::runTick(int t) {
+    pthread_mutex_lock(&mutex);
+    tick    = t;
+    pending = parties;
+    ++generation;
+    pthread_cond_broadcast(&tick_cond);
+    while (pending > 0) {
+        pthread_cond_wait(&done_cond, &mutex);
+    }
+    pthread_mutex_unlock(&mutex);
+}
+
+void TickBarrier::stop() {
+    pthread_mutex_lock(&mutex);
+    stopped = true;
+    ++generation;
+    pthread_cond_broadcast(&tick_cond);
+    pthread_mutex_unlock(&mutex);
+}
+
+bool TickBarrier::awaitTick(unsigned long& seen_generation, int& t) {
+    pthread_mutex_lock(&mutex);
+    while (generation == seen_generation) {
+        pthread_cond_wait(&tick_cond, &mutex);
+    }
+    seen_generation = generation;
+    t = tick;
+    bool running = !stopped;
+    pthread_mutex_unlock(&mutex);
+    return running;
+}
+
+void TickBarrier::finishTick() {
+    pthread_mutex_lock(&mutex);
+    if (--pending == 0) {
+        pthread_cond_signal(&done_cond);
+    }
+    pthread_mutex_unlock(&mutex);
+}
@@ -0,0 +1,44 @@
+#ifndef TICK_BARRIER_H
+#define TICK_BARRIER_H
+
+#include <pthread.h>
+
+// Generation-counted barrier that hands simulated ticks to a fixed number of
+// participant threads.
+//
+// The controller publishes a tick with runTick(), which returns once every
+// participant has called finishTick() for it. Participants wait with
+// awaitTick(), remembering the last generation they saw, so a tick published
+// while a participant is still busy is picked up as soon as it asks again.
+// Every participant therefore processes every tick exactly once, and
+// nothing has to sleep to give the threads time to catch up.
+class TickBarrier {
+    private:
+        pthread_mutex_t mutex;
+        pthread_cond_t  tick_cond;
+        pthread_cond_t  done_cond;
+        unsigned long generation = 0;
+        int tick    = 0;
+        int parties;
+        int pending = 0;
+        bool stopped = false;
+
+    public:
+        explicit TickBarrier(int parties_);
+        ~TickBarrier();
+        TickBarrier(const TickBarrier&) = delete;
+        TickBarrier& operator=(const TickBarrier&) = delete;
+
+        // --- Controller side ---
+        // Publish the tick and wait until all participants finished it
+        void runTick(int t);
+        // Release the participants for good
+        void stop();
+
+        // --- Participant side ---
+        // Wait for a tick newer than seen_generation. Returns false once stopped.
+        bool awaitTick(unsigned long& seen_generation, int& t);
+        void finishTick();
+};
+
+#endif // TICK_BARRIER_H
@@ -0,0 +1,551 @@
+#include "banker.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <new>
+
+using namespace std;
+
+// Zeroed rows of stride ints on a 64-byte boundary
+static int* aligned_rows(size_t rows, int stride) {
+    size_t bytes = rows * stride * sizeof(int);
+    void* p = nullptr;
+    if (posix_memalign(&p, 64, bytes > 0 ? bytes : 64) != 0) throw bad_alloc();
+    memset(p, 0, bytes);
+    return static_cast<int*>(p);
+}
+
+/* ──────────────────────────────────────────────────────────────────
+ *  BANKER
+ * ──────────────────────────────────────────────────────────────────*/
+Banker::Banker() {
+    resize(0, 0);
+}
+
+Banker::~Banker() {
+    release_buffers();
+}
+
+void Banker::release_buffers() {
+    free(avail);
+    free(max_rows);
+    free(alloc_rows);
+    free(need_rows);
+    free(scratch);
+    free(work);
+    free(tree_min);
+    free(tree_lazy);
+    free(slack);
+    avail = max_rows = alloc_rows = need_rows = scratch = work = nullptr;
+    tree_min = tree_lazy = slack = nullptr;
+}
+
+void Banker::resize(int customers, int resources) {
+    release_buffers();
+    n   = customers;
+    m   = resources;
+    row = (m + 7) / 8 * 8;
+    if (row == 0) row = 8;
+
+    avail      = aligned_rows(1, row);
+    max_rows   = aligned_rows(n, row);
+    alloc_rows = aligned_rows(n, row);
+    need_rows  = aligned_rows(n, row);
+    scratch    = aligned_rows(1, row);
+    work       = aligned_rows(1, row);
+    slack      = aligned_rows(1, row);
+    leaves = 1;
+    while (leaves < n) leaves *= 2;
+    tree_min   = aligned_rows(2 * (size_t)leaves, row);
+    tree_lazy  = aligned_rows(2 * (size_t)leaves, row);
+    cache_valid = false;
+
+    cursor.assign(m, 0);
+    pending.assign(n, 0);
+    ready.clear();
+    ready.reserve(n);
+    index_stale = true;
+
+    kernels = row_kernels(row, simd);
+}
+
+void Banker::useSimd(bool enabled) {
+    simd    = enabled;
+    kernels = row_kernels(row, simd);
+}
+
+// One CSV line of integers into values, false if it is not one
+static bool parse_csv_row(const string& line, vector<int>& values) {
+    values.clear();
+    const char* p = line.c_str();
+    for (;;) {
+        char* end;
+        long v = strtol(p, &end, 10);
+        if (end == p) return false;
+        values.push_back((int)v);
+        while (*end == ' ' || *end == '\t' || *end == '\r') ++end;
+        if (*end == '\0') return true;
+        if (*end != ',') return false;
+        p = end + 1;
+    }
+}
+
+// Every non-blank line of a CSV file
+static bool read_csv(const string& path, vector<vector<int> >& rows, string& error) {
+    ifstream in(path);
+    if (!in.is_open()) {
+        error = "Failed to open " + path;
+        return false;
+    }
+    string line;
+    int line_no = 0;
+    vector<int> values;
+    while (getline(in, line)) {
+        ++line_no;
+        if (line.find_first_not_of(" \t\r") == string::npos) continue;
+        if (!parse_csv_row(line, values)) {
+            error = path + ":" + to_string(line_no) + ": expected comma separated integers";
+            return false;
+        }
+        rows.push_back(values);
+    }
+    return true;
+}
+
+bool Banker::load(const string& max_file, const string& alloc_file, string& error) {
+    vector<vector<int> > maximum_, allocation_;
+    if (!read_csv(max_file, maximum_, error) || !read_csv(alloc_file, allocation_, error)) {
+        return false;
+    }
+    if (maximum_.empty()) {
+        error = max_file + " lists no customers";
+        return false;
+    }
+    if (allocation_.size() != maximum_.size()) {
+        error = alloc_file + " and " + max_file + " list different numbers of customers";
+        return false;
+    }
+    size_t width = maximum_[0].size();
+    for (size_t i = 0; i < maximum_.size(); ++i) {
+        if (maximum_[i].size() != width || allocation_[i].size() != width) {
+            error = "customer " + to_string(i) + " does not list " + to_string(width) + " resources";
+            return false;
+        }
+    }
+
+    resize(maximum_.size(), width);
+    for (int i = 0; i < n; ++i) setCustomer(i, maximum_[i].data(), allocation_[i].data());
+    return true;
+}
+
+void Banker::setAvailable(const int* values) {
+    memcpy(avail, values, m * sizeof(int));
+    cache_valid = false;
+}
+
+void Banker::setCustomer(int i, const int* maximum_, const int* allocation_) {
+    int* mx = max_rows + (size_t)i * row;
+    int* al = alloc_rows + (size_t)i * row;
+    int* nd = need_rows + (size_t)i * row;
+    for (int j = 0; j < m; ++j) {
+        mx[j] = maximum_[j];
+        al[j] = allocation_[j];
+        nd[j] = maximum_[j] - allocation_[j];
+    }
+    index_stale = true;
+    cache_valid = false;
+}
+
+const int* Banker::padded(const int* values) {
+    memcpy(scratch, values, m * sizeof(int));
+    return scratch;
+}
+
+/* ──────────────────────────────────────────────────────────────────
+ *  SAFETY CHECK
+ * ──────────────────────────────────────────────────────────────────*/
+void Banker::rebuildIndex() const {
+    by_need.resize((size_t)m * n);
+    need_key.resize((size_t)m * n);
+    rank.resize((size_t)m * n);
+    for (int j = 0; j < m; ++j) {
+        int* ids = &by_need[(size_t)j * n];
+        for (int i = 0; i < n; ++i) ids[i] = i;
+        stable_sort(ids, ids + n, [&](int a, int b) { return need(a)[j] < need(b)[j]; });
+        for (int k = 0; k < n; ++k) {
+            need_key[(size_t)j * n + k] = need(ids[k])[j];
+            rank[(size_t)j * n + ids[k]] = k;
+        }
+    }
+    index_stale = false;
+}
+
+void Banker::reindex(int c) {
+    if (index_stale) return;
+    for (int j = 0; j < m; ++j) {
+        int* key = &need_key[(size_t)j * n];
+        int* ids = &by_need[(size_t)j * n];
+        int* pos = &rank[(size_t)j * n];
+        int v = need(c)[j];
+        int p = pos[c];
+        // Requests lower the need and move the customer left, releases right
+        while (p > 0 && (key[p - 1] > v || (key[p - 1] == v && ids[p - 1] > c))) {
+            key[p] = key[p - 1];
+            ids[p] = ids[p - 1];
+            pos[ids[p]] = p;
+            --p;
+        }
+        while (p + 1 < n && (key[p + 1] < v || (key[p + 1] == v && ids[p + 1] < c))) {
+            key[p] = key[p + 1];
+            ids[p] = ids[p + 1];
+            pos[ids[p]] = p;
+            ++p;
+        }
+        key[p] = v;
+        ids[p] = c;
+        pos[c] = p;
+    }
+}
+
+inline void Banker::advance(int j) const {
+    const int* key = &need_key[(size_t)j * n];
+    const int* ids = &by_need[(size_t)j * n];
+    int k = cursor[j];
+    while (k < n && key[k] <= work[j]) {
+        if (--pending[ids[k]] == 0) ready.push_back(ids[k]);
+        ++k;
+    }
+    cursor[j] = k;
+}
+
+// Work-queue form of the safety algorithm. Work only grows, so the cursor
+// of each resource only moves right, and every customer enters the ready
+// queue once, the moment work covers its last resource.
+bool Banker::isSafe(vector<int>* sequence) const {
+    if (index_stale) rebuildIndex();
+    memcpy(work, avail, row * sizeof(int));
+    ready.clear();
+    pending.assign(n, m);
+    if (m == 0) {
+        for (int i = 0; i < n; ++i) ready.push_back(i);
+    }
+    for (int j = 0; j < m; ++j) {
+        cursor[j] = 0;
+        advance(j);
+    }
+
+    // Let ready customers finish and release what they hold
+    for (size_t head = 0; head < ready.size(); ++head) {
+        const int* al = allocation(ready[head]);
+        kernels.add(work, al, row);
+        for (int j = 0; j < m; ++j) {
+            if (al[j] > 0) advance(j);
+        }
+    }
+
+    if (sequence) sequence->assign(ready.begin(), ready.end());
+    return (int)ready.size() == n;
+}
+
+/* ──────────────────────────────────────────────────────────────────
+ *  FAST PATH
+ * ──────────────────────────────────────────────────────────────────*/
+// Larger than any slack; fills the leaves past the last customer
+static const int NO_LIMIT = 1 << 29;
+
+void Banker::buildCache() {
+    cache_order.assign(ready.begin(), ready.end());
+    cache_pos.resize(n);
+    memcpy(work, avail, row * sizeof(int));
+    for (int k = 0; k < leaves; ++k) {
+        int* leaf = tree_min + (size_t)(leaves + k) * row;
+        if (k < n) {
+            int i = cache_order[k];
+            cache_pos[i] = k;
+            memcpy(leaf, work, row * sizeof(int));
+            kernels.sub(leaf, need(i), row);
+            kernels.add(work, allocation(i), row);
+        } else {
+            for (int j = 0; j < row; ++j) leaf[j] = NO_LIMIT;
+        }
+    }
+    for (int node = leaves - 1; node >= 1; --node) {
+        kernels.min(tree_min + (size_t)node * row, tree_min + (size_t)(2 * node) * row,
+                    tree_min + (size_t)(2 * node + 1) * row, row);
+    }
+    memset(tree_lazy, 0, 2 * (size_t)leaves * row * sizeof(int));
+    cache_valid = true;
+}
+
+void Banker::pushDown(int node) {
+    int* lazy = tree_lazy + (size_t)node * row;
+    for (int child = 2 * node; child <= 2 * node + 1; ++child) {
+        kernels.add(tree_min + (size_t)child * row, lazy, row);
+        kernels.add(tree_lazy + (size_t)child * row, lazy, row);
+    }
+    memset(lazy, 0, row * sizeof(int));
+}
+
+void Banker::addSlack(int node, int lo, int hi, int end, const int* delta, bool subtract) {
+    if (end <= lo) return;
+    if (hi <= end) {
+        if (subtract) {
+            kernels.sub(tree_min + (size_t)node * row, delta, row);
+            kernels.sub(tree_lazy + (size_t)node * row, delta, row);
+        } else {
+            kernels.add(tree_min + (size_t)node * row, delta, row);
+            kernels.add(tree_lazy + (size_t)node * row, delta, row);
+        }
+        return;
+    }
+    pushDown(node);
+    int mid = (lo + hi) / 2;
+    addSlack(2 * node, lo, mid, end, delta, subtract);
+    addSlack(2 * node + 1, mid, hi, end, delta, subtract);
+    kernels.min(tree_min + (size_t)node * row, tree_min + (size_t)(2 * node) * row,
+                tree_min + (size_t)(2 * node + 1) * row, row);
+}
+
+void Banker::minSlack(int node, int lo, int hi, int end) {
+    if (end <= lo) return;
+    if (hi <= end) {
+        kernels.min(slack, slack, tree_min + (size_t)node * row, row);
+        return;
+    }
+    pushDown(node);
+    int mid = (lo + hi) / 2;
+    minSlack(2 * node, lo, mid, end);
+    minSlack(2 * node + 1, mid, hi, end);
+}
+
+/* ──────────────────────────────────────────────────────────────────
+ *  REQUEST AND RELEASE
+ * ──────────────────────────────────────────────────────────────────*/
+BankerStatus Banker::validate(int customer, const int* req) const {
+    for (int j = 0; j < m; ++j) {
+        if (req[j] < 0) return BANKER_EXCEEDS_NEED;
+    }
+    if (!kernels.fits(req, need(customer), row)) return BANKER_EXCEEDS_NEED;
+    if (!kernels.fits(req, avail, row))          return BANKER_UNAVAILABLE;
+    return BANKER_GRANTED;
+}
+
+void Banker::apply(int customer, const int* req) {
+    kernels.sub(avail, req, row);
+    kernels.add(alloc_rows + (size_t)customer * row, req, row);
+    kernels.sub(need_rows + (size_t)customer * row, req, row);
+    reindex(customer);
+}
+
+void Banker::revert(int customer, const int* req) {
+    kernels.add(avail, req, row);
+    kernels.sub(alloc_rows + (size_t)customer * row, req, row);
+    kernels.add(need_rows + (size_t)customer * row, req, row);
+    reindex(customer);
+}
+
+// Fits in the slack of everyone before the customer in the cached sequence
+bool Banker::admitFast(int customer, const int* req) {
+    if (!cache_valid) return false;
+    int p = cache_pos[customer];
+    for (int j = 0; j < row; ++j) slack[j] = NO_LIMIT;
+    minSlack(1, 0, leaves, p);
+    if (!kernels.fits(req, slack, row)) return false;
+    addSlack(1, 0, leaves, p, req, true);
+    apply(customer, req);
+    ++fast_admissions;
+    return true;
+}
+
+BankerStatus Banker::request(int customer, const int* amounts, vector<int>* sequence) {
+    return requestRow(customer, padded(amounts), sequence);
+}
+
+BankerStatus Banker::requestRow(int customer, const int* req, vector<int>* sequence) {
+    BankerStatus status = validate(customer, req);
+    if (status != BANKER_GRANTED) return status;
+    if (admitFast(customer, req)) {
+        if (sequence) *sequence = cache_order;
+        return BANKER_GRANTED;
+    }
+
+    // Tentatively allocate, roll back if that is unsafe
+    apply(customer, req);
+    ++full_checks;
+    if (isSafe(sequence)) {
+        buildCache();
+        return BANKER_GRANTED;
+    }
+    revert(customer, req);
+    return BANKER_UNSAFE;
+}
+
+/* ──────────────────────────────────────────────────────────────────
+ *  BATCHES
+ * ──────────────────────────────────────────────────────────────────*/
+int Banker::admitBatch(const vector<BankerRequest>& batch, BatchMode mode, vector<BankerStatus>& results) {
+    int count = batch.size();
+    results.assign(count, BANKER_DEFERRED);
+    if (count == 0) return 0;
+
+    // Padded copies of the amounts for the row kernels
+    unique_ptr<int, void (*)(void*)> rows(aligned_rows(count, row), free);
+    for (int k = 0; k < count; ++k) {
+        memcpy(rows.get() + (size_t)k * row, batch[k].amounts, m * sizeof(int));
+    }
+    if (mode == BATCH_PREFIX) return admitPrefix(batch, rows.get(), results);
+    return admitGreedy(batch, rows.get(), results);
+}
+
+// Granting more never turns an unsafe state safe, so whether the first t
+// requests keep the state safe is monotone in t and a binary search finds
+// the longest such prefix in O(log count) checks.
+int Banker::admitPrefix(const vector<BankerRequest>& batch, const int* rows, vector<BankerStatus>& results) {
+    int count = batch.size();
+    auto req_of = [&](int k) { return rows + (size_t)k * row; };
+
+    // Requests the cached sequence proves safe cost no check at all
+    int k = 0;
+    while (k < count) {
+        BankerStatus status = validate(batch[k].customer, req_of(k));
+        if (status != BANKER_GRANTED) {
+            results[k] = status;
+            return k;
+        }
+        if (!admitFast(batch[k].customer, req_of(k))) break;
+        results[k++] = BANKER_GRANTED;
+    }
+    if (k == count) return k;
+
+    // Apply the rest as long as each is within need and available. The
+    // cache stays right for the state after k requests only.
+    bool k_safe = cache_valid;
+    cache_valid = false;
+    int valid_end = k;
+    BankerStatus stop = BANKER_GRANTED;
+    while (valid_end < count) {
+        stop = validate(batch[valid_end].customer, req_of(valid_end));
+        if (stop != BANKER_GRANTED) break;
+        apply(batch[valid_end].customer, req_of(valid_end));
+        ++valid_end;
+    }
+
+    int applied = valid_end;
+    auto move_to = [&](int target) {
+        while (applied > target) {
+            --applied;
+            revert(batch[applied].customer, req_of(applied));
+        }
+        while (applied < target) {
+            apply(batch[applied].customer, req_of(applied));
+            ++applied;
+        }
+    };
+    int last_checked = -1;      // prefix of the last check, its sequence is in ready
+    bool last_safe   = false;
+    auto safe_at = [&](int t) {
+        move_to(t);
+        ++full_checks;
+        last_checked = t;
+        last_safe    = isSafe();
+        return last_safe;
+    };
+
+    // lo: longest prefix known to be safe (k - 1: not even k), hi: shortest known unsafe
+    int lo = k_safe ? k : k - 1;
+    int hi = valid_end + 1;
+    if (safe_at(valid_end)) {
+        lo = valid_end;
+    } else {
+        hi = valid_end;
+        while (hi - lo > 1) {
+            int mid = lo + (hi - lo) / 2;
+            if (safe_at(mid)) lo = mid;
+            else              hi = mid;
+        }
+    }
+
+    int admitted = max(lo, k);
+    move_to(admitted);
+    for (int t = k; t < admitted; ++t) results[t] = BANKER_GRANTED;
+    if (admitted < valid_end)   results[admitted] = BANKER_UNSAFE;
+    else if (valid_end < count) results[valid_end] = stop;
+
+    // Cache the sequence of the final state
+    if (last_checked == admitted && last_safe) {
+        buildCache();
+    } else if (admitted == k && k_safe) {
+        cache_valid = true;     // back where the fast path left the tree
+    } else {
+        ++full_checks;
+        if (isSafe()) buildCache();
+    }
+    return admitted;
+}
+
+// Try the whole batch with one check; if that fails, go through it in
+// priority order, each request on the cached sequence where possible.
+int Banker::admitGreedy(const vector<BankerRequest>& batch, const int* rows, vector<BankerStatus>& results) {
+    int count = batch.size();
+    vector<int> order(count);
+    for (int k = 0; k < count; ++k) order[k] = k;
+    stable_sort(order.begin(), order.end(), [&](int a, int b) { return batch[a].priority < batch[b].priority; });
+
+    // Grant on the cached sequence while it proves the requests safe, then
+    // apply every valid request left and check them all at once
+    int fast = 0;
+    int first = count;          // position in order of the first applied request
+    bool was_cached = cache_valid;
+    vector<int> applied;
+    for (int p = 0; p < count; ++p) {
+        int k = order[p];
+        const int* req = rows + (size_t)k * row;
+        results[k] = validate(batch[k].customer, req);
+        if (results[k] != BANKER_GRANTED) continue;
+        if (applied.empty() && cache_valid && admitFast(batch[k].customer, req)) {
+            ++fast;
+            continue;
+        }
+        if (applied.empty()) {
+            first = p;
+            was_cached = cache_valid;
+            cache_valid = false;
+        }
+        apply(batch[k].customer, req);
+        applied.push_back(k);
+    }
+    if (applied.empty()) return fast;
+    ++full_checks;
+    if (isSafe()) {
+        buildCache();
+        return fast + applied.size();
+    }
+
+    // Too much at once: undo and admit the rest one at a time
+    for (size_t i = applied.size(); i-- > 0;) {
+        revert(batch[applied[i]].customer, rows + (size_t)applied[i] * row);
+    }
+    cache_valid = was_cached;
+    int admitted = fast;
+    for (int p = first; p < count; ++p) {
+        int k = order[p];
+        results[k] = requestRow(batch[k].customer, rows + (size_t)k * row, nullptr);
+        if (results[k] == BANKER_GRANTED) ++admitted;
+    }
+    return admitted;
+}
+
+BankerStatus Banker::release(int customer, const int* amounts) {
+    const int* rel = padded(amounts);
+    for (int j = 0; j < m; ++j) {
+        if (rel[j] < 0) return BANKER_EXCEEDS_ALLOCATION;
+    }
+    if (!kernels.fits(rel, allocation(customer), row)) return BANKER_EXCEEDS_ALLOCATION;
+
+    revert(customer, rel);
+    // Only the customers before this one gain slack
+    if (cache_valid) addSlack(1, 0, leaves, cache_pos[customer], rel, false);
+    return BANKER_GRANTED;
+}
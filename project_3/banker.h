@@ -0,0 +1,181 @@
+#ifndef BANKER_H
+#define BANKER_H
+
+#include <string>
+#include <vector>
+#include "banker_kernels.h"
+
+// Outcome of a request or release
+enum BankerStatus {
+    BANKER_GRANTED = 0,
+    BANKER_EXCEEDS_NEED,        // negative, or more than the customer may still claim
+    BANKER_UNAVAILABLE,         // more than is available right now
+    BANKER_UNSAFE,              // granting it could deadlock
+    BANKER_EXCEEDS_ALLOCATION,  // release of more than the customer holds, or negative
+    BANKER_DEFERRED             // batch: not considered, see Banker::admitBatch
+};
+
+// One request of a batch
+struct BankerRequest {
+    int customer;
+    const int* amounts;     // resources() values
+    int priority = 0;       // BATCH_GREEDY: lower goes first
+};
+
+enum BatchMode {
+    BATCH_PREFIX,   // the longest prefix that keeps the state safe
+    BATCH_GREEDY    // in priority order, every request that keeps it safe
+};
+
+/* ──────────────────────────────────────────────────────────────────
+ *  Banker — runtime-dimensioned state of the Banker's algorithm
+ *
+ *  Every resource vector (available, and one row per customer of
+ *  maximum, allocation and need) is stored in a row of stride() ints:
+ *  the resource count rounded up to a multiple of 8, i.e. whole 32-byte
+ *  blocks. Buffers are 64-byte aligned and the padding is always 0, so
+ *  kernels may work on whole rows without a tail loop: AVX2 when the CPU
+ *  has it, portable ones otherwise (see banker_kernels.h).
+ *
+ *  The safety check runs in O(customers x resources): for every resource
+ *  it keeps the customers sorted by need, and a customer becomes runnable
+ *  as soon as work covers its need of every resource. The sorted lists
+ *  are updated in place when a request or release changes one customer.
+ *
+ *  Most requests skip the check altogether. The last safe sequence found
+ *  stays cached with the slack of each position in it: the work available
+ *  when that customer runs, minus its need. A request by the customer at
+ *  position p leaves the sequence safe if it fits in the slack of every
+ *  position before p; later positions get the request back when the
+ *  customer finishes. A segment tree over the positions answers that with
+ *  O(log customers) row operations and takes the request off the slack
+ *  of the prefix just as fast.
+ *
+ *  Customers are numbered 0..customers()-1; passing any other number
+ *  is undefined. Not thread-safe.
+ * ──────────────────────────────────────────────────────────────────*/
+class Banker {
+    public:
+        Banker();
+        ~Banker();
+        Banker(const Banker&) = delete;
+        Banker& operator=(const Banker&) = delete;
+
+        // Read maximum and allocation from CSV files, one customer per line.
+        // The lines of max_file give the number of customers and its first
+        // line the number of resources. On failure error says why.
+        bool load(const std::string& max_file, const std::string& alloc_file, std::string& error);
+        // Empty state of the given size (available, maximum and allocation all 0)
+        void resize(int customers, int resources);
+
+        int customers() const { return n; }
+        int resources() const { return m; }
+        int stride() const    { return row; }
+
+        // Use the AVX2 kernels if the CPU has them (default), or only the
+        // portable ones
+        void useSimd(bool enabled);
+        const char* kernelName() const { return kernels.name; }
+
+        // Rows of resources() values, followed by padding
+        const int* available() const       { return avail; }
+        const int* maximum(int i) const    { return max_rows + (size_t)i * row; }
+        const int* allocation(int i) const { return alloc_rows + (size_t)i * row; }
+        const int* need(int i) const       { return need_rows + (size_t)i * row; }
+
+        // Set from resources() values; need follows as maximum - allocation.
+        // The check rebuilds its index after setCustomer.
+        void setAvailable(const int* values);
+        void setCustomer(int i, const int* maximum_, const int* allocation_);
+
+        // Safety algorithm. Fills sequence, if given, with the customers in
+        // the order they can finish (only those that can, when unsafe).
+        bool isSafe(std::vector<int>* sequence = nullptr) const;
+
+        // Grant amounts (resources() values) to the customer if the state
+        // stays safe, otherwise leave everything as it was
+        BankerStatus request(int customer, const int* amounts, std::vector<int>* sequence = nullptr);
+        // Give back amounts the customer holds; none may be negative
+        BankerStatus release(int customer, const int* amounts);
+
+        // Admit requests together. BATCH_PREFIX stops at the first request
+        // that cannot be granted and defers the rest; it needs O(log size)
+        // safety checks. BATCH_GREEDY grants in priority order (ties in batch
+        // order) with the same outcome as requesting one by one: on the
+        // cached sequence while it proves them safe, then the rest in one
+        // check, and only if that fails request by request. results[k]
+        // tells what became of batch[k]; returns the number granted.
+        int admitBatch(const std::vector<BankerRequest>& batch, BatchMode mode,
+                       std::vector<BankerStatus>& results);
+
+        // Requests granted on the cached sequence, and full checks run
+        long fastAdmissions() const { return fast_admissions; }
+        long fullChecks() const     { return full_checks; }
+
+    private:
+        int n   = 0;
+        int m   = 0;
+        int row = 0;
+        int* avail      = nullptr;
+        int* max_rows   = nullptr;
+        int* alloc_rows = nullptr;
+        int* need_rows  = nullptr;
+        int* scratch    = nullptr;      // request row, padded
+        bool simd = true;
+        RowKernels kernels;     // picked by stride
+
+        // Safety check index: row j lists the customers by their need of
+        // resource j (ties by number), with that need alongside
+        mutable std::vector<int> by_need;
+        mutable std::vector<int> need_key;
+        mutable std::vector<int> rank;          // position of customer i in row j
+        mutable bool index_stale = true;        // rebuilt by the next check
+
+        // Safety check state
+        mutable int* work = nullptr;
+        mutable std::vector<int> cursor;        // per resource: customers in row j covered by work
+        mutable std::vector<int> pending;       // per customer: resources work does not cover yet
+        mutable std::vector<int> ready;         // customers able to finish, in order
+
+        // Fast path: the cached safe sequence, and a segment tree over its
+        // positions. Node rows hold the least slack in the subtree, with
+        // lazy rows of adds still owed to the children.
+        bool cache_valid = false;
+        std::vector<int> cache_order;
+        std::vector<int> cache_pos;     // position of customer i in cache_order
+        int leaves = 0;                 // a power of two
+        int* tree_min  = nullptr;
+        int* tree_lazy = nullptr;
+        int* slack     = nullptr;       // query result
+        long fast_admissions = 0;
+        long full_checks     = 0;
+
+        void release_buffers();
+        void rebuildIndex() const;
+        // Cache the safe sequence in ready and the slack of its positions
+        void buildCache();
+        void pushDown(int node);
+        // Add (or subtract) delta to the slack of positions [0, end)
+        void addSlack(int node, int lo, int hi, int end, const int* delta, bool subtract);
+        // Least slack of positions [0, end), into slack
+        void minSlack(int node, int lo, int hi, int end);
+        // Move the customer to its place in every row after its need changed
+        void reindex(int customer);
+        // Count off the customers whose need of resource j work now covers
+        void advance(int j) const;
+        // Request steps on padded rows
+        BankerStatus validate(int customer, const int* req) const;
+        void apply(int customer, const int* req);
+        void revert(int customer, const int* req);
+        // Grant if the cached sequence proves it safe
+        bool admitFast(int customer, const int* req);
+        BankerStatus requestRow(int customer, const int* req, std::vector<int>* sequence);
+        int admitPrefix(const std::vector<BankerRequest>& batch, const int* rows,
+                        std::vector<BankerStatus>& results);
+        int admitGreedy(const std::vector<BankerRequest>& batch, const int* rows,
+                        std::vector<BankerStatus>& results);
+        // Copy resources() values into the padded scratch row
+        const int* padded(const int* values);
+};
+
+#endif // BANKER_H
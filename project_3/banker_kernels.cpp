@@ -0,0 +1,127 @@
+#include "banker_kernels.h"
+#include <immintrin.h>
+
+/* ──────────────────────────────────────────────────────────────────
+ *  PORTABLE KERNELS
+ * ──────────────────────────────────────────────────────────────────*/
+// Fixed-width rows: the loops unroll completely and run without branches
+template <int STRIDE>
+static bool fits_fixed(const int* a, const int* b, int) {
+    bool ok = true;
+    for (int j = 0; j < STRIDE; ++j) ok &= a[j] <= b[j];
+    return ok;
+}
+
+template <int STRIDE>
+static void add_fixed(int* dst, const int* src, int) {
+    for (int j = 0; j < STRIDE; ++j) dst[j] += src[j];
+}
+
+template <int STRIDE>
+static void sub_fixed(int* dst, const int* src, int) {
+    for (int j = 0; j < STRIDE; ++j) dst[j] -= src[j];
+}
+
+template <int STRIDE>
+static void min_fixed(int* dst, const int* a, const int* b, int) {
+    for (int j = 0; j < STRIDE; ++j) dst[j] = a[j] < b[j] ? a[j] : b[j];
+}
+
+// Any width: stop at the first resource that does not fit
+static bool fits_any(const int* a, const int* b, int stride) {
+    for (int j = 0; j < stride; ++j) {
+        if (a[j] > b[j]) return false;
+    }
+    return true;
+}
+
+static void add_any(int* dst, const int* src, int stride) {
+    for (int j = 0; j < stride; ++j) dst[j] += src[j];
+}
+
+static void sub_any(int* dst, const int* src, int stride) {
+    for (int j = 0; j < stride; ++j) dst[j] -= src[j];
+}
+
+static void min_any(int* dst, const int* a, const int* b, int stride) {
+    for (int j = 0; j < stride; ++j) dst[j] = a[j] < b[j] ? a[j] : b[j];
+}
+
+/* ──────────────────────────────────────────────────────────────────
+ *  AVX2 KERNELS
+ *  STRIDE 0 means any width, read from the argument.
+ * ──────────────────────────────────────────────────────────────────*/
+// Compare eight resources at once and collect the lanes where a > b.
+// Wide rows check the mask every 32 resources to stop early.
+template <int STRIDE>
+__attribute__((target("avx2")))
+static bool fits_avx2(const int* a, const int* b, int stride) {
+    const int len = STRIDE ? STRIDE : stride;
+    __m256i over = _mm256_setzero_si256();
+    for (int j = 0; j < len; j += 8) {
+        __m256i va = _mm256_load_si256(reinterpret_cast<const __m256i*>(a + j));
+        __m256i vb = _mm256_load_si256(reinterpret_cast<const __m256i*>(b + j));
+        over = _mm256_or_si256(over, _mm256_cmpgt_epi32(va, vb));
+        if (!STRIDE && (j & 31) == 24 && _mm256_movemask_epi8(over) != 0) return false;
+    }
+    return _mm256_movemask_epi8(over) == 0;
+}
+
+template <int STRIDE>
+__attribute__((target("avx2")))
+static void add_avx2(int* dst, const int* src, int stride) {
+    const int len = STRIDE ? STRIDE : stride;
+    for (int j = 0; j < len; j += 8) {
+        __m256i* d = reinterpret_cast<__m256i*>(dst + j);
+        __m256i s  = _mm256_load_si256(reinterpret_cast<const __m256i*>(src + j));
+        _mm256_store_si256(d, _mm256_add_epi32(_mm256_load_si256(d), s));
+    }
+}
+
+template <int STRIDE>
+__attribute__((target("avx2")))
+static void sub_avx2(int* dst, const int* src, int stride) {
+    const int len = STRIDE ? STRIDE : stride;
+    for (int j = 0; j < len; j += 8) {
+        __m256i* d = reinterpret_cast<__m256i*>(dst + j);
+        __m256i s  = _mm256_load_si256(reinterpret_cast<const __m256i*>(src + j));
+        _mm256_store_si256(d, _mm256_sub_epi32(_mm256_load_si256(d), s));
+    }
+}
+
+template <int STRIDE>
+__attribute__((target("avx2")))
+static void min_avx2(int* dst, const int* a, const int* b, int stride) {
+    const int len = STRIDE ? STRIDE : stride;
+    for (int j = 0; j < len; j += 8) {
+        __m256i va = _mm256_load_si256(reinterpret_cast<const __m256i*>(a + j));
+        __m256i vb = _mm256_load_si256(reinterpret_cast<const __m256i*>(b + j));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(dst + j), _mm256_min_epi32(va, vb));
+    }
+}
+
+/* ──────────────────────────────────────────────────────────────────
+ *  SELECTION
+ * ──────────────────────────────────────────────────────────────────*/
+static const RowKernels scalar8  = {"scalar8",  fits_fixed<8>,  add_fixed<8>,  sub_fixed<8>,  min_fixed<8>};
+static const RowKernels scalar16 = {"scalar16", fits_fixed<16>, add_fixed<16>, sub_fixed<16>, min_fixed<16>};
+static const RowKernels scalar   = {"scalar",   fits_any,       add_any,       sub_any,       min_any};
+static const RowKernels avx2_8   = {"avx2x8",   fits_avx2<8>,   add_avx2<8>,   sub_avx2<8>,   min_avx2<8>};
+static const RowKernels avx2_16  = {"avx2x16",  fits_avx2<16>,  add_avx2<16>,  sub_avx2<16>,  min_avx2<16>};
+static const RowKernels avx2     = {"avx2",     fits_avx2<0>,   add_avx2<0>,   sub_avx2<0>,   min_avx2<0>};
+
+bool cpu_has_avx2() {
+    static const bool has = __builtin_cpu_supports("avx2");
+    return has;
+}
+
+const RowKernels& row_kernels(int stride, bool simd) {
+    if (simd && cpu_has_avx2()) {
+        if (stride == 8)  return avx2_8;
+        if (stride == 16) return avx2_16;
+        return avx2;
+    }
+    if (stride == 8)  return scalar8;
+    if (stride == 16) return scalar16;
+    return scalar;
+}
@@ -0,0 +1,27 @@
+#ifndef BANKER_KERNELS_H
+#define BANKER_KERNELS_H
+
+/* ──────────────────────────────────────────────────────────────────
+ *  Whole-row kernels of the Banker's algorithm
+ *
+ *  Rows are stride ints, stride a multiple of 8, starting on a 32-byte
+ *  boundary (see banker.h). The AVX2 kernels handle eight resources per
+ *  instruction; they are compiled for AVX2 whatever the build flags and
+ *  only picked when the CPU supports it. The portable kernels are
+ *  unrolled at compile time for rows of 8 and 16 ints.
+ * ──────────────────────────────────────────────────────────────────*/
+struct RowKernels {
+    const char* name;
+    bool (*fits)(const int* a, const int* b, int stride);    // a <= b everywhere
+    void (*add)(int* dst, const int* src, int stride);
+    void (*sub)(int* dst, const int* src, int stride);
+    void (*min)(int* dst, const int* a, const int* b, int stride);  // dst may be a or b
+};
+
+// Fastest kernels for the stride, portable ones only unless simd
+const RowKernels& row_kernels(int stride, bool simd = true);
+
+// Whether this CPU runs the AVX2 kernels
+bool cpu_has_avx2();
+
+#endif // BANKER_KERNELS_H
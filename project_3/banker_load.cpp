@@ -0,0 +1,281 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+// Load generator for banker_server. Every client opens its own connection
+// and keeps --depth commands in flight: it requests one unit of two random
+// resources for a random customer, and once it holds --hold grants, or
+// when a request is denied, it gives back the oldest. After --seconds it
+// returns everything it holds. Prints the commands, requests and grants
+// per second, the share of requests granted and the latency of a command
+// from sending it to reading its answer.
+
+/* ──────────────────────────────────────────────────────────────────
+ *  OPTIONS
+ * ──────────────────────────────────────────────────────────────────*/
+struct LoadOptions {
+    string socket_path = "banker.sock";
+    int clients = 8;
+    int depth   = 16;       // commands in flight per connection
+    int hold    = 8;        // grants a client holds before releasing
+    double seconds = 2.0;
+    unsigned seed = 1;
+};
+
+typedef chrono::steady_clock Clock;
+
+struct ClientResult {
+    long commands = 0;
+    long requests = 0;
+    long granted  = 0;
+    long errors   = 0;      // INVALID, DENIED allocation or a lost connection
+    vector<float> latency_us;
+};
+
+struct Grant {
+    int customer;
+    int first, second;      // the resources it holds one unit of
+};
+
+// A command sent and not answered yet
+struct InFlight {
+    Clock::time_point sent;
+    bool request;
+    Grant grant;
+};
+
+/* ──────────────────────────────────────────────────────────────────
+ *  CONNECTION
+ * ──────────────────────────────────────────────────────────────────*/
+class LineSocket {
+    public:
+        ~LineSocket() { if (fd >= 0) close(fd); }
+
+        bool connect_to(const string& path) {
+            fd = socket(AF_UNIX, SOCK_STREAM, 0);
+            sockaddr_un addr;
+            memset(&addr, 0, sizeof(addr));
+            addr.sun_family = AF_UNIX;
+            strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+            return fd >= 0 && connect(fd, (sockaddr*)&addr, sizeof(addr)) == 0;
+        }
+
+        bool send_all(const string& data) {
+            size_t done = 0;
+            while (done < data.size()) {
+                ssize_t put = send(fd, data.data() + done, data.size() - done, MSG_NOSIGNAL);
+                if (put <= 0) return false;
+                done += put;
+            }
+            return true;
+        }
+
+        // Next answer line, without the newline; blocks until there is one
+        bool read_line(string& line) {
+            for (;;) {
+                size_t eol = buffer.find('\n', pos);
+                if (eol != string::npos) {
+                    line.assign(buffer, pos, eol - pos);
+                    pos = eol + 1;
+                    return true;
+                }
+                buffer.erase(0, pos);
+                pos = 0;
+                char chunk[65536];
+                ssize_t got = recv(fd, chunk, sizeof(chunk), 0);
+                if (got <= 0) return false;
+                buffer.append(chunk, got);
+            }
+        }
+
+    private:
+        int fd = -1;
+        string buffer;
+        size_t pos = 0;
+};
+
+// Ask the server for its size: "STATE ... customers <n> available <r0> ... <rn>"
+static bool query_size(LineSocket& sock, int& customers, int& resources) {
+    string line, word;
+    if (!sock.send_all("*\n") || !sock.read_line(line)) return false;
+    istringstream ss(line);
+    customers = resources = 0;
+    while (ss >> word) {
+        if (word == "customers") ss >> customers;
+        if (word == "available") {
+            int value;
+            while (ss >> value) ++resources;
+        }
+    }
+    return customers > 0 && resources > 0;
+}
+
+static string command_line(const char* op, const Grant& g, int resources) {
+    string line = op;
+    line += ' ';
+    line += to_string(g.customer);
+    for (int j = 0; j < resources; ++j) {
+        line += (j == g.first || j == g.second) ? " 1" : " 0";
+    }
+    line += '\n';
+    return line;
+}
+
+/* ──────────────────────────────────────────────────────────────────
+ *  CLIENT
+ * ──────────────────────────────────────────────────────────────────*/
+static void client(const LoadOptions& options, int id, const atomic<bool>& stop, ClientResult& result) {
+    LineSocket sock;
+    int customers, resources;
+    if (!sock.connect_to(options.socket_path) || !query_size(sock, customers, resources)) {
+        ++result.errors;
+        return;
+    }
+    mt19937 rng(options.seed * 7919 + id);
+    deque<Grant> holding;
+    deque<InFlight> in_flight;
+    int releasing = 0;          // RL commands in flight
+    int owed = 0;               // releases to send for denied requests
+    string out, line;
+
+    for (;;) {
+        bool stopped = stop.load(memory_order_relaxed);
+        // Top the pipeline up
+        out.clear();
+        Clock::time_point now = Clock::now();
+        while ((int)in_flight.size() < options.depth) {
+            InFlight f;
+            f.sent = now;
+            if (!holding.empty() && (stopped || owed > 0 || (int)(holding.size() + releasing) >= options.hold)) {
+                if (owed > 0) --owed;
+                f.request = false;
+                f.grant = holding.front();
+                holding.pop_front();
+                ++releasing;
+                out += command_line("RL", f.grant, resources);
+            } else if (!stopped) {
+                f.request = true;
+                f.grant.customer = rng() % customers;
+                f.grant.first  = rng() % resources;
+                f.grant.second = rng() % resources;
+                out += command_line("RQ", f.grant, resources);
+            } else {
+                break;
+            }
+            in_flight.push_back(f);
+        }
+        if (in_flight.empty()) break;
+        if (!out.empty() && !sock.send_all(out)) break;
+
+        // Read at least one answer, and whatever else has arrived
+        do {
+            if (!sock.read_line(line)) {
+                ++result.errors;
+                return;
+            }
+            InFlight f = in_flight.front();
+            in_flight.pop_front();
+            float us = chrono::duration<float, micro>(Clock::now() - f.sent).count();
+            result.latency_us.push_back(us);
+            ++result.commands;
+            if (f.request) {
+                ++result.requests;
+                if (line == "GRANTED") {
+                    ++result.granted;
+                    holding.push_back(f.grant);
+                } else if (line == "INVALID") {
+                    ++result.errors;
+                } else if ((int)holding.size() > owed) {
+                    // Denied: free something up rather than ask again
+                    // against the same state
+                    ++owed;
+                }
+            } else {
+                --releasing;
+                if (line != "RELEASED") ++result.errors;
+            }
+        } while ((int)in_flight.size() > options.depth / 2);
+    }
+    if (!in_flight.empty()) ++result.errors;
+}
+
+/* ──────────────────────────────────────────────────────────────────
+ *  MAIN
+ * ──────────────────────────────────────────────────────────────────*/
+int main(int argc, char* argv[]) {
+    LoadOptions options;
+    for (int i = 1; i < argc; ++i) {
+        if (strncmp(argv[i], "--socket=", 9) == 0 && argv[i][9] != '\0') {
+            options.socket_path = argv[i] + 9;
+        } else if (strncmp(argv[i], "--clients=", 10) == 0 && atoi(argv[i] + 10) > 0) {
+            options.clients = atoi(argv[i] + 10);
+        } else if (strncmp(argv[i], "--depth=", 8) == 0 && atoi(argv[i] + 8) > 0) {
+            options.depth = atoi(argv[i] + 8);
+        } else if (strncmp(argv[i], "--hold=", 7) == 0 && atoi(argv[i] + 7) > 0) {
+            options.hold = atoi(argv[i] + 7);
+        } else if (strncmp(argv[i], "--seconds=", 10) == 0 && atof(argv[i] + 10) > 0) {
+            options.seconds = atof(argv[i] + 10);
+        } else if (strncmp(argv[i], "--seed=", 7) == 0) {
+            options.seed = strtoul(argv[i] + 7, nullptr, 10);
+        } else {
+            cout << "Usage: " << argv[0] << " [--socket=PATH] [--clients=N] [--depth=D] [--hold=H]"
+                 << " [--seconds=S] [--seed=S]\n";
+            return 1;
+        }
+    }
+
+    vector<ClientResult> results(options.clients);
+    vector<thread> pool;
+    atomic<bool> stop(false);
+    Clock::time_point start = Clock::now();
+    for (int t = 0; t < options.clients; ++t) {
+        pool.emplace_back(client, cref(options), t, cref(stop), ref(results[t]));
+    }
+    this_thread::sleep_for(chrono::duration<double>(options.seconds));
+    stop.store(true);
+    for (thread& th : pool) th.join();
+    double elapsed = chrono::duration<double>(Clock::now() - start).count();
+
+    ClientResult total;
+    for (ClientResult& r : results) {
+        total.commands += r.commands;
+        total.requests += r.requests;
+        total.granted  += r.granted;
+        total.errors   += r.errors;
+        total.latency_us.insert(total.latency_us.end(), r.latency_us.begin(), r.latency_us.end());
+    }
+    vector<float>& lat = total.latency_us;
+    sort(lat.begin(), lat.end());
+    auto percentile = [&](double p) {
+        return lat.empty() ? 0.0f : lat[min(lat.size() - 1, (size_t)(p / 100 * lat.size()))];
+    };
+
+    cout << options.clients << " clients, " << options.depth << " in flight each, "
+         << elapsed << " s\n";
+    cout << fixed << setprecision(0);
+    cout << "Commands/s: " << total.commands / elapsed
+         << "  requests/s: " << total.requests / elapsed
+         << "  granted/s: " << total.granted / elapsed
+         << "  errors: " << total.errors << '\n';
+    cout << setprecision(1);
+    cout << "Granted: " << 100.0 * total.granted / max(total.requests, 1L) << "% of requests\n";
+    cout << "Latency us: p50 " << percentile(50) << "  p90 " << percentile(90)
+         << "  p99 " << percentile(99) << "  p99.9 " << percentile(99.9)
+         << "  max " << (lat.empty() ? 0.0f : lat.back()) << '\n';
+    return total.errors == 0 ? 0 : 1;
+}
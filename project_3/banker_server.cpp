@@ -0,0 +1,413 @@
+#include <cctype>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "banker.h"
+#include "command.h"
+
+using namespace std;
+
+/* ──────────────────────────────────────────────────────────────────
+ *  Banker's algorithm over a Unix-domain socket
+ *
+ *  Loads max.txt and allocation.txt like the interactive program and
+ *  takes the available resources as arguments. Clients send the same
+ *  command lines (RQ, RL, *, EXIT) and get one line back per command,
+ *  in order:
+ *      RQ  -> GRANTED | DENIED need | DENIED available | DENIED unsafe
+ *      RL  -> RELEASED | DENIED allocation
+ *      *   -> STATE SAFE|UNSAFE customers <n> available <r0> ... <rn>
+ *      EXIT-> BYE, then the server closes the connection
+ *      anything else, or an unknown customer -> INVALID
+ *  A client may pipeline: send many lines without waiting for answers.
+ *
+ *  One thread serves every connection from an epoll loop. The RQ lines
+ *  that are waiting across all connections are admitted together with
+ *  Banker::admitBatch (BATCH_GREEDY, all of the same priority): the
+ *  outcome is that of taking them one by one in arrival order, but they
+ *  share one safety check unless granting all of them is unsafe. A
+ *  connection's lines are answered strictly in order: a line behind one
+ *  of its requests waits for the batch.
+ * ──────────────────────────────────────────────────────────────────*/
+
+struct ServerOptions {
+    string socket_path = "banker.sock";
+    int max_batch = 4096;       // requests admitted together at most
+};
+
+// Unsent replies beyond which a connection is not read until it catches up
+static const size_t OUT_LIMIT = 1 << 20;
+
+struct Connection {
+    int fd = -1;
+    string in;
+    size_t parsed = 0;          // start of the first unanswered line
+    string out;
+    size_t sent = 0;
+    bool eof = false;           // peer done sending, or EXIT
+    bool failed = false;
+    uint32_t events = 0;        // registered with epoll
+};
+
+// A request waiting for the batch
+struct Pending {
+    Connection* conn;
+    size_t line_end;
+    int customer;
+};
+
+static volatile sig_atomic_t stopping = 0;
+
+static void on_signal(int) {
+    stopping = 1;
+}
+
+/* ──────────────────────────────────────────────────────────────────
+ *  SERVER
+ * ──────────────────────────────────────────────────────────────────*/
+class BankerServer {
+    public:
+        BankerServer(Banker& bank_, const ServerOptions& options_) : bank(bank_), options(options_) {}
+        bool open(string& error);
+        void run();
+        void printStats(ostream& out) const;
+
+    private:
+        Banker& bank;
+        ServerOptions options;
+        int listener = -1;
+        int epoll_fd = -1;
+        unordered_map<int, Connection> conns;
+
+        // Reused by every batch
+        vector<Pending> pending;
+        vector<int> rows;               // resources() values per pending request
+        vector<BankerRequest> batch;
+        vector<BankerStatus> results;
+        Command parsed;
+
+        long commands  = 0;
+        long requests  = 0;
+        long batches   = 0;
+        long connected = 0;
+
+        void accept_all();
+        void read_all(Connection& c);
+        void flush(Connection& c);
+        void update_events(Connection& c);
+        void close_conn(Connection& c);
+        // Answer every complete line that can be answered now
+        void serve();
+        void answer_request(Connection& c, BankerStatus status);
+        // A line other than RQ; amounts as parsed for RL
+        void execute(Connection& c, const Command& command, const int* amounts);
+};
+
+bool BankerServer::open(string& error) {
+    listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listener < 0) {
+        error = string("socket: ") + strerror(errno);
+        return false;
+    }
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (options.socket_path.size() >= sizeof(addr.sun_path)) {
+        error = "Socket path too long: " + options.socket_path;
+        return false;
+    }
+    strcpy(addr.sun_path, options.socket_path.c_str());
+    unlink(options.socket_path.c_str());
+    if (bind(listener, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(listener, SOMAXCONN) < 0) {
+        error = options.socket_path + ": " + strerror(errno);
+        return false;
+    }
+
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.fd = listener;
+    if (epoll_fd < 0 || epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listener, &ev) < 0) {
+        error = string("epoll: ") + strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+void BankerServer::run() {
+    epoll_event events[64];
+    while (!stopping) {
+        int k = epoll_wait(epoll_fd, events, 64, -1);
+        if (k < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait");
+            break;
+        }
+        for (int e = 0; e < k; ++e) {
+            int fd = events[e].data.fd;
+            if (fd == listener) {
+                accept_all();
+                continue;
+            }
+            auto it = conns.find(fd);
+            if (it == conns.end()) continue;
+            if (events[e].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) read_all(it->second);
+        }
+
+        serve();
+
+        // Send the answers, drop finished connections
+        vector<int> done;
+        for (auto& kv : conns) {
+            Connection& c = kv.second;
+            flush(c);
+            bool answered = c.in.find('\n', c.parsed) == string::npos;
+            if (c.failed || (c.eof && answered && c.sent == c.out.size())) {
+                done.push_back(kv.first);
+            } else {
+                update_events(c);
+            }
+        }
+        for (int fd : done) close_conn(conns[fd]);
+    }
+    for (auto& kv : conns) close(kv.first);
+    close(listener);
+    close(epoll_fd);
+    unlink(options.socket_path.c_str());
+}
+
+void BankerServer::accept_all() {
+    for (;;) {
+        int fd = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+        Connection& c = conns[fd];
+        c.fd = fd;
+        c.events = EPOLLIN;
+        epoll_event ev;
+        ev.events = c.events;
+        ev.data.fd = fd;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+        ++connected;
+    }
+}
+
+void BankerServer::read_all(Connection& c) {
+    char buffer[65536];
+    for (;;) {
+        ssize_t got = read(c.fd, buffer, sizeof(buffer));
+        if (got > 0) {
+            c.in.append(buffer, got);
+            if (c.out.size() - c.sent > OUT_LIMIT) return;
+            continue;
+        }
+        if (got == 0) {
+            c.eof = true;
+        } else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            c.failed = true;
+        }
+        return;
+    }
+}
+
+void BankerServer::flush(Connection& c) {
+    while (c.sent < c.out.size()) {
+        ssize_t put = send(c.fd, c.out.data() + c.sent, c.out.size() - c.sent, MSG_NOSIGNAL);
+        if (put < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) c.failed = true;
+            break;
+        }
+        c.sent += put;
+    }
+    if (c.sent == c.out.size()) {
+        c.out.clear();
+        c.sent = 0;
+    }
+}
+
+void BankerServer::update_events(Connection& c) {
+    uint32_t wanted = 0;
+    if (!c.eof && c.out.size() - c.sent <= OUT_LIMIT) wanted |= EPOLLIN;
+    if (c.sent < c.out.size()) wanted |= EPOLLOUT;
+    if (wanted == c.events) return;
+    c.events = wanted;
+    epoll_event ev;
+    ev.events = wanted;
+    ev.data.fd = c.fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, c.fd, &ev);
+}
+
+void BankerServer::close_conn(Connection& c) {
+    int fd = c.fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    conns.erase(fd);
+}
+
+/* ──────────────────────────────────────────────────────────────────
+ *  ANSWERING LINES
+ * ──────────────────────────────────────────────────────────────────*/
+void BankerServer::serve() {
+    int m = bank.resources();
+    for (;;) {
+        pending.clear();
+        rows.clear();
+        bool progress = false;
+
+        // Queue the leading requests of every connection; answer other
+        // lines right away unless a request of theirs is queued ahead
+        for (auto& kv : conns) {
+            Connection& c = kv.second;
+            if (c.failed || c.out.size() - c.sent > OUT_LIMIT) continue;
+            size_t pos = c.parsed;
+            bool queued = false;
+            while ((int)pending.size() < options.max_batch) {
+                const char* line = c.in.data() + pos;
+                const char* eol = static_cast<const char*>(memchr(line, '\n', c.in.size() - pos));
+                if (!eol) break;
+                // Amounts go straight into the batch rows; kept only for a request
+                size_t row_start = rows.size();
+                rows.resize(row_start + m);
+                CommandType type = parse_command(line, eol, bank.customers(), m, parsed, &rows[row_start]);
+                if (type == CMD_REQUEST) {
+                    pending.push_back(Pending{&c, (size_t)(eol - c.in.data()), parsed.customer});
+                    queued = true;
+                    pos = eol - c.in.data() + 1;
+                    continue;
+                }
+                if (queued) {
+                    rows.resize(row_start);
+                    break;
+                }
+                execute(c, parsed, &rows[row_start]);
+                rows.resize(row_start);
+                pos = eol - c.in.data() + 1;
+                c.parsed = pos;
+                progress = true;
+                if (type == CMD_EXIT) {
+                    c.in.resize(pos);   // ignore anything after EXIT
+                    break;
+                }
+            }
+        }
+        if (pending.empty()) {
+            if (!progress) break;
+            continue;
+        }
+
+        batch.resize(pending.size());
+        for (size_t k = 0; k < pending.size(); ++k) {
+            batch[k].customer = pending[k].customer;
+            batch[k].amounts  = &rows[k * m];
+            batch[k].priority = 0;
+        }
+        bank.admitBatch(batch, BATCH_GREEDY, results);
+        ++batches;
+        requests += pending.size();
+        for (size_t k = 0; k < pending.size(); ++k) {
+            answer_request(*pending[k].conn, results[k]);
+            pending[k].conn->parsed = pending[k].line_end + 1;
+        }
+    }
+
+    // Drop the answered lines
+    for (auto& kv : conns) {
+        Connection& c = kv.second;
+        if (c.parsed == 0) continue;
+        c.in.erase(0, c.parsed);
+        c.parsed = 0;
+    }
+}
+
+void BankerServer::answer_request(Connection& c, BankerStatus status) {
+    ++commands;
+    switch (status) {
+        case BANKER_GRANTED:      c.out += "GRANTED\n"; break;
+        case BANKER_EXCEEDS_NEED: c.out += "DENIED need\n"; break;
+        case BANKER_UNAVAILABLE:  c.out += "DENIED available\n"; break;
+        default:                  c.out += "DENIED unsafe\n"; break;
+    }
+}
+
+void BankerServer::execute(Connection& c, const Command& command, const int* amounts) {
+    ++commands;
+    int m = bank.resources();
+    if (command.type == CMD_RELEASE) {
+        c.out += bank.release(command.customer, amounts) == BANKER_GRANTED ? "RELEASED\n" : "DENIED allocation\n";
+    } else if (command.type == CMD_STATE) {
+        c.out += bank.isSafe() ? "STATE SAFE" : "STATE UNSAFE";
+        c.out += " customers " + to_string(bank.customers()) + " available";
+        for (int j = 0; j < m; ++j) c.out += " " + to_string(bank.available()[j]);
+        c.out += "\n";
+    } else if (command.type == CMD_EXIT) {
+        c.out += "BYE\n";
+        c.eof = true;
+    } else {
+        c.out += "INVALID\n";
+    }
+}
+
+void BankerServer::printStats(ostream& out) const {
+    out << "Connections: " << connected << ", commands: " << commands << '\n';
+    out << "Requests: " << requests << " in " << batches << " batches ("
+        << (batches ? (double)requests / batches : 0.0) << " per batch)\n";
+    out << "Admitted on the cached sequence: " << bank.fastAdmissions()
+        << ", full safety checks: " << bank.fullChecks() << '\n';
+}
+
+/* ──────────────────────────────────────────────────────────────────
+ *  MAIN
+ * ──────────────────────────────────────────────────────────────────*/
+int main(int argc, char* argv[]) {
+    ServerOptions options;
+    vector<int> available;
+    bool usage = false;
+    for (int i = 1; i < argc; ++i) {
+        if (strncmp(argv[i], "--socket=", 9) == 0 && argv[i][9] != '\0') {
+            options.socket_path = argv[i] + 9;
+        } else if (strncmp(argv[i], "--max-batch=", 12) == 0 && atoi(argv[i] + 12) > 0) {
+            options.max_batch = atoi(argv[i] + 12);
+        } else if (argv[i][0] != '-' || isdigit((unsigned char)argv[i][1])) {
+            available.push_back(atoi(argv[i]));
+        } else {
+            usage = true;
+        }
+    }
+
+    Banker bank;
+    string error;
+    if (!bank.load("max.txt", "allocation.txt", error)) {
+        cerr << error << endl;
+        return 1;
+    }
+    if (usage || (int)available.size() != bank.resources()) {
+        cout << "Usage: " << argv[0] << " [--socket=PATH] [--max-batch=N] <r0> ... <r"
+             << bank.resources() - 1 << ">\n";
+        cout << "  --socket=PATH   Unix-domain socket to listen on (default banker.sock)\n";
+        cout << "  --max-batch=N   requests admitted together at most (default 4096)\n";
+        return 1;
+    }
+    bank.setAvailable(available.data());
+
+    BankerServer server(bank, options);
+    if (!server.open(error)) {
+        cerr << error << endl;
+        return 1;
+    }
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    cout << "Serving " << bank.customers() << " customers, " << bank.resources()
+         << " resource types on " << options.socket_path << " (Ctrl-C to stop)" << endl;
+    server.run();
+    server.printStats(cout);
+    return 0;
+}
@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "banker.h"
+#include "banker_kernels.h"
+
+using namespace std;
+
+// Kernel benchmark of the Banker's algorithm at 64 to 256 resource types.
+// For the portable and (if the CPU has it) the AVX2 kernels it prints the
+// time of one need <= work row compare and one row update, one full safety
+// check, how many request/release pairs are handled per second, and the
+// share of requests admitted on the cached safe sequence.
+
+/* ──────────────────────────────────────────────────────────────────
+ *  OPTIONS
+ * ──────────────────────────────────────────────────────────────────*/
+struct BenchOptions {
+    int customers = 1024;
+    int requests  = 20000;      // request/release pairs per run
+    unsigned seed = 1;
+};
+
+typedef chrono::steady_clock Clock;
+
+static double seconds_since(Clock::time_point start) {
+    return chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Random state that is safe: every need fits in what is available
+static void fill_state(Banker& bank, int customers, int resources, mt19937& rng) {
+    bank.resize(customers, resources);
+    vector<int> maximum(resources), allocation(resources), available(resources, 10);
+    for (int i = 0; i < customers; ++i) {
+        for (int j = 0; j < resources; ++j) {
+            maximum[j]    = rng() % 10;
+            allocation[j] = rng() % (maximum[j] + 1);
+        }
+        bank.setCustomer(i, maximum.data(), allocation.data());
+    }
+    bank.setAvailable(available.data());
+}
+
+/* ──────────────────────────────────────────────────────────────────
+ *  ONE RUN
+ * ──────────────────────────────────────────────────────────────────*/
+static void run(const BenchOptions& options, int resources, bool simd) {
+    mt19937 rng(options.seed);
+    Banker bank;
+    fill_state(bank, options.customers, resources, rng);
+    bank.useSimd(simd);
+    const RowKernels& kernels = row_kernels(bank.stride(), simd);
+    int stride = bank.stride();
+    int n = bank.customers();
+
+    // Row kernels over every customer, against a 32-byte aligned work row
+    void* buffer = nullptr;
+    if (posix_memalign(&buffer, 64, stride * sizeof(int)) != 0) return;
+    int* work = static_cast<int*>(buffer);
+    memcpy(work, bank.available(), stride * sizeof(int));
+    const int passes = 50;
+    long fitting = 0;
+    Clock::time_point start = Clock::now();
+    for (int p = 0; p < passes; ++p) {
+        for (int i = 0; i < n; ++i) fitting += kernels.fits(bank.need(i), work, stride);
+    }
+    double fits_ns = seconds_since(start) * 1e9 / ((double)passes * n);
+
+    start = Clock::now();
+    for (int p = 0; p < passes; ++p) {
+        for (int i = 0; i < n; ++i) kernels.add(work, bank.allocation(i), stride);
+    }
+    double add_ns = seconds_since(start) * 1e9 / ((double)passes * n);
+    free(buffer);
+
+    // Full safety checks
+    const int checks = 20;
+    bool safe = bank.isSafe();
+    start = Clock::now();
+    for (int c = 0; c < checks; ++c) safe &= bank.isSafe();
+    double check_ms = seconds_since(start) * 1e3 / checks;
+
+    // Small requests, each given back right away
+    vector<int> amounts(resources);
+    long granted = 0;
+    start = Clock::now();
+    for (int r = 0; r < options.requests; ++r) {
+        int customer = rng() % n;
+        fill(amounts.begin(), amounts.end(), 0);
+        for (int k = 0; k < 4; ++k) {
+            int j = rng() % resources;
+            amounts[j] = min(1, bank.need(customer)[j]);
+        }
+        if (bank.request(customer, amounts.data()) == BANKER_GRANTED) {
+            ++granted;
+            bank.release(customer, amounts.data());
+        }
+    }
+    double pairs_per_s = options.requests / seconds_since(start);
+
+    cout << setw(9) << resources << setw(10) << bank.kernelName()
+         << setw(12) << fits_ns << setw(12) << add_ns
+         << setw(12) << check_ms << setw(14) << (long)pairs_per_s
+         << setw(8) << (safe ? "yes" : "NO") << setw(10) << granted << setw(9) << fitting / passes
+         << setw(8) << 100.0 * bank.fastAdmissions() / max(granted, 1L) << '\n';
+}
+
+/* ──────────────────────────────────────────────────────────────────
+ *  MAIN
+ * ──────────────────────────────────────────────────────────────────*/
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        if (strncmp(argv[i], "--customers=", 12) == 0 && atoi(argv[i] + 12) > 0) {
+            options.customers = atoi(argv[i] + 12);
+        } else if (strncmp(argv[i], "--requests=", 11) == 0 && atoi(argv[i] + 11) > 0) {
+            options.requests = atoi(argv[i] + 11);
+        } else if (strncmp(argv[i], "--seed=", 7) == 0) {
+            options.seed = strtoul(argv[i] + 7, nullptr, 10);
+        } else {
+            cout << "Usage: " << argv[0] << " [--customers=N] [--requests=R] [--seed=S]\n";
+            return 1;
+        }
+    }
+
+    cout << options.customers << " customers, AVX2 " << (cpu_has_avx2() ? "available" : "not available") << '\n';
+    cout << setw(9) << "resources" << setw(10) << "kernels"
+         << setw(12) << "fits_ns" << setw(12) << "add_ns"
+         << setw(12) << "check_ms" << setw(14) << "rq+rl/s"
+         << setw(8) << "safe" << setw(10) << "granted" << setw(9) << "fitting"
+         << setw(8) << "fast%" << '\n';
+    cout << fixed << setprecision(3);
+    const int sizes[] = {64, 128, 256};
+    for (int resources : sizes) {
+        run(options, resources, false);
+        if (cpu_has_avx2()) run(options, resources, true);
+    }
+    return 0;
+}
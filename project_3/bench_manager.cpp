@@ -0,0 +1,191 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include "banker.h"
+#include "resource_manager.h"
+
+using namespace std;
+
+// Stress benchmark of ResourceManager. Client threads request a few
+// units for random customers, hold up to --hold grants each and give back
+// the oldest, for --seconds per thread count. Prints requests, admitted
+// requests and releases per second, next to the same load on a Banker
+// behind one mutex, and checks that everything adds up afterwards.
+
+/* ──────────────────────────────────────────────────────────────────
+ *  OPTIONS
+ * ──────────────────────────────────────────────────────────────────*/
+struct StressOptions {
+    int customers = 256;
+    int resources = 16;
+    int hold      = 8;      // grants a thread holds before releasing
+    double seconds = 1.0;   // per run
+    int max_threads = 0;    // default: 2 x number of cores, at least 8
+    unsigned seed = 1;
+};
+
+typedef chrono::steady_clock Clock;
+
+// The single-lock baseline
+class LockedBanker {
+    public:
+        Banker bank;
+        BankerStatus request(int customer, const int* amounts) {
+            lock_guard<mutex> guard(lock);
+            return bank.request(customer, amounts);
+        }
+        BankerStatus release(int customer, const int* amounts) {
+            lock_guard<mutex> guard(lock);
+            return bank.release(customer, amounts);
+        }
+        bool isSafe() {
+            lock_guard<mutex> guard(lock);
+            return bank.isSafe();
+        }
+        int available(int j) const { return bank.available()[j]; }
+    private:
+        mutex lock;
+};
+
+// Random safe state: nothing allocated, every maximum fits in available
+template <class Manager>
+static void fill_state(Manager& manager, const StressOptions& options) {
+    mt19937 rng(options.seed);
+    manager.resize(options.customers, options.resources);
+    vector<int> maximum(options.resources), allocation(options.resources, 0);
+    vector<int> available(options.resources, 12);
+    for (int i = 0; i < options.customers; ++i) {
+        for (int j = 0; j < options.resources; ++j) maximum[j] = rng() % 10;
+        manager.setCustomer(i, maximum.data(), allocation.data());
+    }
+    manager.setAvailable(available.data());
+}
+
+struct Counts {
+    long requests = 0;
+    long granted  = 0;
+    long released = 0;
+};
+
+struct Grant {
+    int customer;
+    vector<int> amounts;
+};
+
+/* ──────────────────────────────────────────────────────────────────
+ *  ONE RUN
+ * ──────────────────────────────────────────────────────────────────*/
+template <class Manager>
+static void client(Manager& manager, const StressOptions& options, int id,
+                   const atomic<bool>& stop, Counts& counts) {
+    mt19937 rng(options.seed * 7919 + id);
+    deque<Grant> holding;
+    vector<int> amounts(options.resources);
+    while (!stop.load(memory_order_relaxed)) {
+        if ((int)holding.size() >= options.hold) {
+            Grant& oldest = holding.front();
+            if (manager.release(oldest.customer, oldest.amounts.data()) == BANKER_GRANTED) ++counts.released;
+            holding.pop_front();
+            continue;
+        }
+        int customer = rng() % options.customers;
+        fill(amounts.begin(), amounts.end(), 0);
+        for (int k = 0; k < 2; ++k) amounts[rng() % options.resources] = 1;
+        ++counts.requests;
+        if (manager.request(customer, amounts.data()) == BANKER_GRANTED) {
+            ++counts.granted;
+            holding.push_back(Grant{customer, amounts});
+        }
+    }
+    for (const Grant& g : holding) {
+        if (manager.release(g.customer, g.amounts.data()) == BANKER_GRANTED) ++counts.released;
+    }
+}
+
+template <class Manager>
+static void run(Manager& manager, const char* name, const StressOptions& options, int threads) {
+    vector<Counts> counts(threads);
+    vector<thread> pool;
+    atomic<bool> stop(false);
+    Clock::time_point start = Clock::now();
+    for (int t = 0; t < threads; ++t) {
+        pool.emplace_back(client<Manager>, ref(manager), cref(options), t, cref(stop), ref(counts[t]));
+    }
+    this_thread::sleep_for(chrono::duration<double>(options.seconds));
+    stop.store(true);
+    for (thread& th : pool) th.join();
+    double elapsed = chrono::duration<double>(Clock::now() - start).count();
+
+    Counts total;
+    for (const Counts& c : counts) {
+        total.requests += c.requests;
+        total.granted  += c.granted;
+        total.released += c.released;
+    }
+    // Every grant was given back, so available is where it started
+    bool consistent = total.released == total.granted && manager.isSafe();
+    for (int j = 0; j < options.resources; ++j) consistent &= manager.available(j) == 12;
+
+    cout << setw(8) << threads << setw(10) << name
+         << setw(14) << (long)(total.requests / elapsed)
+         << setw(14) << (long)(total.granted / elapsed)
+         << setw(14) << (long)(total.released / elapsed)
+         << setw(8) << 100.0 * total.granted / max(total.requests, 1L)
+         << setw(12) << (consistent ? "yes" : "NO") << '\n';
+}
+
+/* ──────────────────────────────────────────────────────────────────
+ *  MAIN
+ * ──────────────────────────────────────────────────────────────────*/
+int main(int argc, char* argv[]) {
+    StressOptions options;
+    for (int i = 1; i < argc; ++i) {
+        if (strncmp(argv[i], "--customers=", 12) == 0 && atoi(argv[i] + 12) > 0) {
+            options.customers = atoi(argv[i] + 12);
+        } else if (strncmp(argv[i], "--resources=", 12) == 0 && atoi(argv[i] + 12) > 0) {
+            options.resources = atoi(argv[i] + 12);
+        } else if (strncmp(argv[i], "--hold=", 7) == 0 && atoi(argv[i] + 7) > 0) {
+            options.hold = atoi(argv[i] + 7);
+        } else if (strncmp(argv[i], "--seconds=", 10) == 0 && atof(argv[i] + 10) > 0) {
+            options.seconds = atof(argv[i] + 10);
+        } else if (strncmp(argv[i], "--threads=", 10) == 0 && atoi(argv[i] + 10) > 0) {
+            options.max_threads = atoi(argv[i] + 10);
+        } else if (strncmp(argv[i], "--seed=", 7) == 0) {
+            options.seed = strtoul(argv[i] + 7, nullptr, 10);
+        } else {
+            cout << "Usage: " << argv[0] << " [--customers=N] [--resources=M] [--hold=H] [--seconds=S]"
+                 << " [--threads=T] [--seed=S]\n";
+            return 1;
+        }
+    }
+    if (options.max_threads == 0) {
+        options.max_threads = max(8, 2 * (int)thread::hardware_concurrency());
+    }
+
+    cout << options.customers << " customers, " << options.resources << " resources, "
+         << thread::hardware_concurrency() << " cores\n";
+    cout << setw(8) << "threads" << setw(10) << "manager"
+         << setw(14) << "requests/s" << setw(14) << "admitted/s"
+         << setw(14) << "releases/s" << setw(8) << "adm%"
+         << setw(12) << "consistent" << '\n';
+    cout << fixed << setprecision(1);
+    for (int threads = 1; threads <= options.max_threads; threads *= 2) {
+        ResourceManager manager;
+        fill_state(manager, options);
+        run(manager, "resmgr", options, threads);
+
+        LockedBanker locked;
+        fill_state(locked.bank, options);
+        run(locked, "mutex", options, threads);
+    }
+    return 0;
+}
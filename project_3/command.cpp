@@ -0,0 +1,73 @@
+#include "command.h"
+#include <climits>
+#include <cstring>
+
+// Same set as isspace in the "C" locale, without the locale lookup
+static inline bool is_space(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// Step over whitespace and the token after it: [token, p) on return
+static inline const char* next_token(const char*& p, const char* end) {
+    while (p < end && is_space(*p)) ++p;
+    const char* token = p;
+    while (p < end && !is_space(*p)) ++p;
+    return token;
+}
+
+static inline bool token_is(const char* token, const char* p, const char* word) {
+    size_t length = strlen(word);
+    return (size_t)(p - token) == length && memcmp(token, word, length) == 0;
+}
+
+// Optional '-' and at least one digit, within the range of int
+static bool parse_int(const char* token, const char* p, int& value) {
+    bool negative = token < p && *token == '-';
+    if (negative) ++token;
+    if (token == p) return false;
+    long long limit = negative ? -(long long)INT_MIN : INT_MAX;
+    long long v = 0;
+    for (; token < p; ++token) {
+        if (*token < '0' || *token > '9') return false;
+        v = v * 10 + (*token - '0');
+        if (v > limit) return false;
+    }
+    value = (int)(negative ? -v : v);
+    return true;
+}
+
+CommandType parse_command(const char* begin, const char* end, int customers, int resources,
+                          Command& command, int* amounts) {
+    command = Command();
+    const char* p = begin;
+    const char* token = next_token(p, end);
+
+    CommandType type = CMD_INVALID;
+    if (token_is(token, p, "RQ"))         type = CMD_REQUEST;
+    else if (token_is(token, p, "RL"))    type = CMD_RELEASE;
+    else if (token_is(token, p, "*"))     type = CMD_STATE;
+    else if (token_is(token, p, "EXIT"))  type = CMD_EXIT;
+    else if (token_is(token, p, "BATCH")) type = CMD_BATCH;
+    else return CMD_INVALID;
+
+    if (type == CMD_REQUEST || type == CMD_RELEASE) {
+        int customer;
+        token = next_token(p, end);
+        if (!parse_int(token, p, customer) || customer < 0 || customer >= customers) return CMD_INVALID;
+        for (int j = 0; j < resources; ++j) {
+            token = next_token(p, end);
+            if (!parse_int(token, p, amounts[j])) return CMD_INVALID;
+        }
+        command.customer = customer;
+    } else if (type == CMD_BATCH) {
+        token = next_token(p, end);
+        if (token_is(token, p, "GREEDY"))       command.greedy = true;
+        else if (!token_is(token, p, "PREFIX")) return CMD_INVALID;
+    }
+
+    // Nothing may follow
+    token = next_token(p, end);
+    if (token != p) return CMD_INVALID;
+    command.type = type;
+    return type;
+}
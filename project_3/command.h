@@ -0,0 +1,34 @@
+#ifndef COMMAND_H
+#define COMMAND_H
+
+// Command lines shared by the interactive loop (main.cpp) and the socket
+// server (banker_server.cpp):
+//   RQ <cid> <r0> ... <rn>, RL <cid> <r0> ... <rn>, *, EXIT, BATCH PREFIX|GREEDY
+// Tokens are separated by whitespace; numbers are decimal, optionally
+// negative, and must fit in an int.
+
+// Values match the codes the command loop has always used
+enum CommandType {
+    CMD_INVALID = 0,
+    CMD_REQUEST = 1,    // RQ
+    CMD_RELEASE = 2,    // RL
+    CMD_STATE   = 3,    // *
+    CMD_EXIT    = 4,
+    CMD_BATCH   = 5
+};
+
+struct Command {
+    CommandType type = CMD_INVALID;
+    int customer = -1;      // RQ, RL
+    bool greedy = false;    // BATCH GREEDY rather than BATCH PREFIX
+};
+
+// Validate the line [begin, end) and extract its fields in one pass,
+// straight from the buffer and without allocating. RQ and RL need exactly
+// resources amounts, written to amounts, and a customer in
+// [0, customers). Returns command.type; on CMD_INVALID amounts may have
+// been partly written.
+CommandType parse_command(const char* begin, const char* end, int customers, int resources,
+                          Command& command, int* amounts);
+
+#endif // COMMAND_H
@@ -0,0 +1,162 @@
+#include "resource_manager.h"
+
+using namespace std;
+
+/* ──────────────────────────────────────────────────────────────────
+ *  SETUP
+ * ──────────────────────────────────────────────────────────────────*/
+ResourceManager::ResourceManager() {
+    resize(0, 0);
+}
+
+bool ResourceManager::load(const string& max_file, const string& alloc_file, string& error) {
+    if (!bank.load(max_file, alloc_file, error)) return false;
+    publish();
+    return true;
+}
+
+void ResourceManager::resize(int customers, int resources) {
+    bank.resize(customers, resources);
+    publish();
+}
+
+void ResourceManager::setAvailable(const int* values) {
+    bank.setAvailable(values);
+    for (int j = 0; j < m; ++j) avail[j].store(values[j]);
+}
+
+void ResourceManager::setCustomer(int i, const int* maximum_, const int* allocation_) {
+    bank.setCustomer(i, maximum_, allocation_);
+    for (int j = 0; j < m; ++j) {
+        maximum[(size_t)i * m + j] = maximum_[j];
+        held[(size_t)i * m + j].store(allocation_[j]);
+    }
+}
+
+void ResourceManager::publish() {
+    n = bank.customers();
+    m = bank.resources();
+    size_t cells = (size_t)n * m;
+    rows.assign(m, 0);
+    maximum.assign(cells, 0);
+    avail.reset(new atomic<int>[m]);
+    held.reset(new atomic<int>[cells]);
+    returned.reset(new atomic<int>[cells]);
+    dirty.reset(new atomic<bool>[n]);
+    next.assign(n, -1);
+    dirty_head.store(-1);
+
+    for (int j = 0; j < m; ++j) avail[j].store(bank.available()[j]);
+    for (int i = 0; i < n; ++i) {
+        dirty[i].store(false);
+        for (int j = 0; j < m; ++j) {
+            maximum[(size_t)i * m + j] = bank.maximum(i)[j];
+            held[(size_t)i * m + j].store(bank.allocation(i)[j]);
+            returned[(size_t)i * m + j].store(0);
+        }
+    }
+}
+
+/* ──────────────────────────────────────────────────────────────────
+ *  REQUEST — optimistic validation, then the check under the lock
+ * ──────────────────────────────────────────────────────────────────*/
+BankerStatus ResourceManager::request(int customer, const int* amounts) {
+    const int* max_row = &maximum[(size_t)customer * m];
+    atomic<int>* held_row = &held[(size_t)customer * m];
+
+    // The atomics are never behind: held is at most the customer's
+    // allocation and avail at least what is really available, so a
+    // request they refuse would be refused by the Banker too
+    for (int j = 0; j < m; ++j) {
+        if (amounts[j] < 0 || amounts[j] > max_row[j] - held_row[j].load()) {
+            ++optimistic_rejects;
+            return BANKER_EXCEEDS_NEED;
+        }
+    }
+    for (int j = 0; j < m; ++j) {
+        if (amounts[j] > avail[j].load()) {
+            ++optimistic_rejects;
+            return BANKER_UNAVAILABLE;
+        }
+    }
+
+    lock_guard<mutex> guard(lock);
+    ++locked_requests;
+    drain();
+    BankerStatus status = bank.request(customer, amounts);
+    if (status == BANKER_GRANTED) {
+        // bank.available() <= avail, so avail stays >= 0
+        for (int j = 0; j < m; ++j) {
+            if (amounts[j] == 0) continue;
+            avail[j].fetch_sub(amounts[j]);
+            held_row[j].fetch_add(amounts[j]);
+        }
+    }
+    return status;
+}
+
+/* ──────────────────────────────────────────────────────────────────
+ *  RELEASE — lock-free
+ * ──────────────────────────────────────────────────────────────────*/
+BankerStatus ResourceManager::release(int customer, const int* amounts) {
+    atomic<int>* held_row = &held[(size_t)customer * m];
+    atomic<int>* returned_row = &returned[(size_t)customer * m];
+
+    // Take the units off the customer, putting them back if it holds
+    // fewer than it releases of some resource
+    for (int j = 0; j < m; ++j) {
+        int want = amounts[j];
+        int have = held_row[j].load();
+        bool ok = want >= 0;
+        while (ok && want > 0) {
+            if (have < want) ok = false;
+            else if (held_row[j].compare_exchange_weak(have, have - want)) break;
+        }
+        if (!ok) {
+            for (int k = 0; k < j; ++k) {
+                if (amounts[k] > 0) held_row[k].fetch_add(amounts[k]);
+            }
+            return BANKER_EXCEEDS_ALLOCATION;
+        }
+    }
+
+    // available first: the Banker must not see units avail does not have
+    bool any = false;
+    for (int j = 0; j < m; ++j) {
+        if (amounts[j] == 0) continue;
+        avail[j].fetch_add(amounts[j]);
+        returned_row[j].fetch_add(amounts[j]);
+        any = true;
+    }
+
+    // Queue the customer for the next drain unless it already is
+    if (any && !dirty[customer].exchange(true)) {
+        int head = dirty_head.load();
+        do {
+            next[customer] = head;
+        } while (!dirty_head.compare_exchange_weak(head, customer));
+    }
+    return BANKER_GRANTED;
+}
+
+void ResourceManager::drain() {
+    int i = dirty_head.exchange(-1);
+    while (i != -1) {
+        int after = next[i];
+        // Cleared before reading returned: a release from now on queues
+        // the customer again, so none of its units are left behind
+        dirty[i].store(false);
+        atomic<int>* returned_row = &returned[(size_t)i * m];
+        for (int j = 0; j < m; ++j) {
+            rows[j] = returned_row[j].load() != 0 ? returned_row[j].exchange(0) : 0;
+        }
+        bank.release(i, rows.data());
+        i = after;
+    }
+}
+
+bool ResourceManager::isSafe(vector<int>* sequence) {
+    lock_guard<mutex> guard(lock);
+    drain();
+    return bank.isSafe(sequence);
+}
@@ -0,0 +1,95 @@
+#ifndef RESOURCE_MANAGER_H
+#define RESOURCE_MANAGER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "banker.h"
+
+/* ──────────────────────────────────────────────────────────────────
+ *  ResourceManager — a Banker that many threads may call at once
+ *
+ *  available and the units every customer holds are kept twice: in
+ *  atomics that any thread reads and updates, and in the Banker, which
+ *  only the thread holding the lock touches.
+ *
+ *  A release never takes the lock. It takes the units off the
+ *  customer's atomic count (failing if it holds fewer), adds them to
+ *  available, and leaves them in a per-customer "returned" row on a
+ *  lock-free list. The next request under the lock drains the list
+ *  into the Banker. So the Banker only ever lags behind: it sees less
+ *  available and more allocated than there is, never the other way.
+ *
+ *  A request is first validated optimistically against the atomics.
+ *  More than the customer may still claim, or more than is available
+ *  at that instant, is refused there without the lock. Otherwise the
+ *  lock is taken around draining the releases and the Banker's own
+ *  check, which is usually the fast path on the cached safe sequence
+ *  (see banker.h); a grant is then published to the atomics.
+ *
+ *  The setup calls (load, resize, setAvailable, setCustomer) are not
+ *  thread-safe and must finish before the threads start. Customers are
+ *  numbered 0..customers()-1 as for Banker.
+ * ──────────────────────────────────────────────────────────────────*/
+class ResourceManager {
+    public:
+        ResourceManager();
+        ResourceManager(const ResourceManager&) = delete;
+        ResourceManager& operator=(const ResourceManager&) = delete;
+
+        // Same as Banker
+        bool load(const std::string& max_file, const std::string& alloc_file, std::string& error);
+        void resize(int customers, int resources);
+        void setAvailable(const int* values);
+        void setCustomer(int i, const int* maximum_, const int* allocation_);
+
+        int customers() const { return n; }
+        int resources() const { return m; }
+
+        // Grant amounts (resources() values) if the state stays safe
+        BankerStatus request(int customer, const int* amounts);
+        // Give back amounts the customer holds; lock-free. Negative
+        // amounts are refused as BANKER_EXCEEDS_ALLOCATION.
+        BankerStatus release(int customer, const int* amounts);
+
+        // Safety algorithm on the current state, as Banker::isSafe
+        bool isSafe(std::vector<int>* sequence = nullptr);
+
+        // Snapshots, each value read atomically
+        int available(int j) const       { return avail[j].load(); }
+        int allocation(int i, int j) const { return held[(size_t)i * m + j].load(); }
+
+        // Requests refused before taking the lock, and taken under it
+        long optimisticRejects() const { return optimistic_rejects.load(); }
+        long lockedRequests() const    { return locked_requests.load(); }
+
+    private:
+        int n = 0;
+        int m = 0;
+        Banker bank;            // guarded by lock
+        std::mutex lock;
+        std::vector<int> rows;  // release amounts being drained, guarded by lock
+
+        std::vector<int> maximum;                       // n x m, fixed after setup
+        std::unique_ptr<std::atomic<int>[]> avail;      // m
+        std::unique_ptr<std::atomic<int>[]> held;       // n x m, at most what bank has allocated
+        std::unique_ptr<std::atomic<int>[]> returned;   // n x m, released but not in bank yet
+
+        // Customers with returned units: a stack linked through next,
+        // each customer on it at most once (while its dirty flag is set)
+        std::unique_ptr<std::atomic<bool>[]> dirty;
+        std::vector<int> next;
+        std::atomic<int> dirty_head{-1};
+
+        std::atomic<long> optimistic_rejects{0};
+        std::atomic<long> locked_requests{0};
+
+        // Copy the Banker's state into the atomics after setup
+        void publish();
+        // Hand the returned units to the Banker; lock held
+        void drain();
+};
+
+#endif // RESOURCE_MANAGER_H